@@ -0,0 +1,563 @@
+////////////////////////////////////////////////////////////////////////////////
+// FILE: ring_bench.cpp
+// DATE: 2026-10-14
+// AUTH: Trevor Wilson
+// DESC: Benchmarks rings and other queues across thread counts and message sizes
+
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2016 Trevor Wilson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy 
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell 
+// copies of the Software, and to permit persons to whom the Software is 
+// furnished to do so, subject to the following conditions :
+// 
+//   The above copyright notice and this permission notice shall be included in
+//   all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE 
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+////////////////////////////////////////////////////////////////////////////////
+// Building and running
+//
+//   g++ -std=c++11 -O2 -pthread -Iwilt-ring -o ring_bench bench/ring_bench.cpp
+//       wilt-ring/ring.cpp wilt-ring/message_ring.cpp wilt-ring/slot_ring.cpp
+//       wilt-ring/histogram.cpp
+//
+// Baselines need their libraries and are enabled with macros:
+//
+//   -DWILT_BENCH_BOOST      boost::lockfree::queue (header-only)
+//   -DWILT_BENCH_MOODYCAMEL moodycamel::ConcurrentQueue, with -I pointing at
+//                           the directory holding concurrentqueue.h
+//
+// Options select what is swept, lists are comma separated:
+//
+//   -p 1,2,4       producer thread counts
+//   -c 1,2,4       consumer thread counts
+//   -s 8,64,...    message sizes in bytes (at least 8)
+//   -q ring,...    queues: ring, ring-try, typed, message, slot, mutex,
+//                  boost, moodycamel
+//   -b bytes       bytes written per case (the message count is derived
+//                  from it, at least 10000 messages)
+//   -r bytes       ring capacity in bytes
+//   -w strategy    wait strategy of the rings: spin, backoff or block. Spin
+//                  only makes sense with no more threads than cpus
+//   --pin          pins threads to cpus, producers first
+//
+// Every message carries the time it was written, consumers record the delay
+// until they read it. Throughput is measured from the start signal until all
+// messages are read. The default ring capacity isn't a multiple of the odd
+// message sizes, so those also exercise the wrapped copy path.
+
+#include "ring.h"
+#include "message_ring.h"
+#include "slot_ring.h"
+#include "histogram.h"
+
+#include <algorithm>
+// - std::find
+#include <atomic>
+// - std::atomic
+#include <chrono>
+// - std::chrono::steady_clock
+#include <condition_variable>
+// - std::condition_variable
+#include <cstdint>
+// - std::int64_t
+// - std::uint64_t
+#include <cstdio>
+// - std::printf
+#include <cstdlib>
+// - std::strtoull
+#include <cstring>
+// - std::memcpy
+// - std::strcmp
+#include <deque>
+// - std::deque
+#include <memory>
+// - std::unique_ptr
+#include <mutex>
+// - std::mutex
+#include <string>
+// - std::string
+#include <thread>
+// - std::thread
+#include <vector>
+// - std::vector
+
+#if defined(WILT_BENCH_BOOST)
+#include <boost/lockfree/queue.hpp>
+// - boost::lockfree::queue
+#endif
+
+#if defined(WILT_BENCH_MOODYCAMEL)
+#include <concurrentqueue.h>
+// - moodycamel::ConcurrentQueue
+#endif
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+// - SetThreadAffinityMask
+#elif defined(__linux__)
+#include <pthread.h>
+// - pthread_setaffinity_np
+#endif
+
+namespace
+{
+  //////////////////////////////////////////////////////////////////////////////
+  // Settings of a run
+
+  struct Settings
+  {
+    std::vector<int>         producers;
+    std::vector<int>         consumers;
+    std::vector<std::size_t> sizes;
+    std::vector<std::string> queues;
+    std::uint64_t            bytes;    // bytes written per case
+    std::size_t              capacity; // ring capacity in bytes
+    wilt::RingOptions        options;  // options of the rings
+    bool                     pin;
+
+    Settings()
+      : producers({ 1, 2, 4 })
+      , consumers({ 1, 2, 4 })
+      , sizes({ 8, 64, 100, 1000, 4096, 65536 })
+      , queues({ "ring", "ring-try", "typed", "message", "slot", "mutex", "boost", "moodycamel" })
+      , bytes(256ull << 20)
+      , capacity(1 << 20)
+      , pin(false)
+    { }
+
+  }; // struct Settings
+
+  // Results of one case
+  struct Result
+  {
+    double        seconds;
+    std::uint64_t messages;
+    std::uint64_t p50;
+    std::uint64_t p99;
+    std::uint64_t p999;
+  };
+
+  std::int64_t now()
+  {
+    return static_cast<std::int64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+  }
+
+  void pin_thread(unsigned cpu)
+  {
+    auto cpus = std::thread::hardware_concurrency();
+    if (cpus == 0)
+      return;
+
+    cpu %= cpus;
+#if defined(_WIN32)
+    SetThreadAffinityMask(GetCurrentThread(), static_cast<DWORD_PTR>(1) << cpu);
+#elif defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+    (void)cpu;
+#endif
+  }
+
+  // Yields after spinning for a while so that try_* loops don't starve the
+  // threads they are waiting on when there are more threads than cpus
+  void backoff(int& spins)
+  {
+    if (++spins > 64)
+      std::this_thread::yield();
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  // Queues being measured. Each has blocking push and pop of a message of a
+  // fixed size, where the first 8 bytes are the time it was written
+
+  template <std::size_t N>
+  struct Message
+  {
+    char data[N];
+  };
+
+  template <std::size_t N>
+  class RawRing
+  {
+  public:
+    RawRing(const Settings& settings) : ring_(settings.capacity, settings.options) { }
+    void push(const Message<N>& message) { ring_.write(message.data, N); }
+    void pop(Message<N>& message)        { ring_.read(message.data, N); }
+
+  private:
+    wilt::Ring_ ring_;
+  };
+
+  template <std::size_t N>
+  class RawRingTry
+  {
+  public:
+    RawRingTry(const Settings& settings) : ring_(settings.capacity, settings.options) { }
+    void push(const Message<N>& message) { for (int i = 0; !ring_.try_write(message.data, N); ) backoff(i); }
+    void pop(Message<N>& message)        { for (int i = 0; !ring_.try_read(message.data, N); ) backoff(i); }
+
+  private:
+    wilt::Ring_ ring_;
+  };
+
+  template <std::size_t N>
+  class TypedRing
+  {
+  public:
+    TypedRing(const Settings& settings) : ring_(settings.capacity / N, settings.options) { }
+    void push(const Message<N>& message) { ring_.write(message); }
+    void pop(Message<N>& message)        { ring_.read(message); }
+
+  private:
+    wilt::Ring<Message<N>> ring_;
+  };
+
+  template <std::size_t N>
+  class FramedRing
+  {
+  public:
+    FramedRing(const Settings& settings) : ring_(settings.capacity, settings.options) { }
+    void push(const Message<N>& message) { ring_.write(message.data, N); }
+    void pop(Message<N>& message)        { ring_.read(message.data, N); }
+
+  private:
+    wilt::MessageRing ring_;
+  };
+
+  template <std::size_t N>
+  class SlotQueue
+  {
+  public:
+    SlotQueue(const Settings& settings) : ring_(settings.capacity / N, settings.options) { }
+    void push(const Message<N>& message) { ring_.write(message); }
+    void pop(Message<N>& message)        { ring_.read(message); }
+
+  private:
+    wilt::SlotRing<Message<N>> ring_;
+  };
+
+  template <std::size_t N>
+  class MutexDeque
+  {
+  public:
+    MutexDeque(const Settings& settings) : capacity_(settings.capacity / N) { }
+
+    void push(const Message<N>& message)
+    {
+      std::unique_lock<std::mutex> lock(lock_);
+      not_full_.wait(lock, [&]{ return queue_.size() < capacity_; });
+      queue_.push_back(message);
+      not_empty_.notify_one();
+    }
+
+    void pop(Message<N>& message)
+    {
+      std::unique_lock<std::mutex> lock(lock_);
+      not_empty_.wait(lock, [&]{ return !queue_.empty(); });
+      message = queue_.front();
+      queue_.pop_front();
+      not_full_.notify_one();
+    }
+
+  private:
+    std::size_t               capacity_;
+    std::deque<Message<N>>    queue_;
+    std::mutex                lock_;
+    std::condition_variable   not_full_;
+    std::condition_variable   not_empty_;
+  };
+
+#if defined(WILT_BENCH_BOOST)
+  template <std::size_t N>
+  class BoostQueue
+  {
+  public:
+    BoostQueue(const Settings& settings) : queue_(settings.capacity / N) { }
+    void push(const Message<N>& message) { for (int i = 0; !queue_.bounded_push(message); ) backoff(i); }
+    void pop(Message<N>& message)        { for (int i = 0; !queue_.pop(message); ) backoff(i); }
+
+  private:
+    boost::lockfree::queue<Message<N>> queue_;
+  };
+#endif
+
+#if defined(WILT_BENCH_MOODYCAMEL)
+  template <std::size_t N>
+  class MoodyQueue
+  {
+  public:
+    MoodyQueue(const Settings& settings) : queue_(settings.capacity / N) { }
+    void push(const Message<N>& message) { for (int i = 0; !queue_.try_enqueue(message); ) backoff(i); }
+    void pop(Message<N>& message)        { for (int i = 0; !queue_.try_dequeue(message); ) backoff(i); }
+
+  private:
+    moodycamel::ConcurrentQueue<Message<N>> queue_;
+  };
+#endif
+
+  //////////////////////////////////////////////////////////////////////////////
+  // Runs one case. Producers split the messages evenly, consumers claim them
+  // one at a time so that every blocking pop has a matching push
+
+  template <class Queue, std::size_t N>
+  Result run(Queue& queue, int producers, int consumers, std::uint64_t count, bool pin)
+  {
+    count = count / producers * producers;
+
+    std::atomic<bool>          go(false);
+    std::atomic<std::uint64_t> claimed(0);
+    std::vector<std::unique_ptr<wilt::LatencyHistogram>> latencies;
+    std::vector<std::thread> threads;
+
+    for (int p = 0; p < producers; ++p)
+    {
+      threads.emplace_back([&, p]{
+        if (pin)
+          pin_thread(static_cast<unsigned>(p));
+
+        Message<N> message;
+        std::memset(message.data, p, N);
+        while (!go.load())
+          std::this_thread::yield();
+
+        for (auto i = count / producers; i > 0; --i)
+        {
+          auto stamp = now();
+          std::memcpy(message.data, &stamp, sizeof(stamp));
+          queue.push(message);
+        }
+      });
+    }
+
+    for (int c = 0; c < consumers; ++c)
+    {
+      latencies.emplace_back(new wilt::LatencyHistogram());
+      auto& latency = *latencies.back();
+      threads.emplace_back([&, c]{
+        if (pin)
+          pin_thread(static_cast<unsigned>(producers + c));
+
+        Message<N> message;
+        while (!go.load())
+          std::this_thread::yield();
+
+        while (claimed.fetch_add(1, std::memory_order_relaxed) < count)
+        {
+          queue.pop(message);
+
+          std::int64_t stamp;
+          std::memcpy(&stamp, message.data, sizeof(stamp));
+          auto delay = now() - stamp;
+          latency.record(delay > 0 ? static_cast<std::uint64_t>(delay) : 0);
+        }
+      });
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    go.store(true);
+    for (auto& thread : threads)
+      thread.join();
+    auto end = std::chrono::steady_clock::now();
+
+    wilt::LatencyHistogram latency;
+    for (auto& histogram : latencies)
+      latency.merge(*histogram);
+
+    Result result;
+    result.seconds  = std::chrono::duration<double>(end - start).count();
+    result.messages = count;
+    result.p50      = latency.percentile(50.0);
+    result.p99      = latency.percentile(99.0);
+    result.p999     = latency.percentile(99.9);
+    return result;
+  }
+
+  template <class Queue, std::size_t N>
+  void report(const char* name, const Settings& settings, int producers, int consumers)
+  {
+    Queue queue(settings);
+
+    auto count = settings.bytes / N;
+    if (count < 10000)
+      count = 10000;
+
+    auto result = run<Queue, N>(queue, producers, consumers, count, settings.pin);
+    auto rate = static_cast<double>(result.messages) / result.seconds;
+    std::printf("%-10s %3d %3d %7zu %12.0f %10.1f %10llu %10llu %10llu\n",
+      name, producers, consumers, N, rate, rate * N / (1 << 20),
+      static_cast<unsigned long long>(result.p50),
+      static_cast<unsigned long long>(result.p99),
+      static_cast<unsigned long long>(result.p999));
+    std::fflush(stdout);
+  }
+
+  template <std::size_t N>
+  void sweep(const Settings& settings)
+  {
+    auto selected = [&](const char* queue) {
+      return std::find(settings.queues.begin(), settings.queues.end(), queue) != settings.queues.end();
+    };
+
+    for (auto producers : settings.producers)
+    {
+      for (auto consumers : settings.consumers)
+      {
+        if (selected("ring"))
+          report<RawRing<N>, N>("ring", settings, producers, consumers);
+        if (selected("ring-try"))
+          report<RawRingTry<N>, N>("ring-try", settings, producers, consumers);
+        if (selected("typed"))
+          report<TypedRing<N>, N>("typed", settings, producers, consumers);
+        if (selected("message"))
+          report<FramedRing<N>, N>("message", settings, producers, consumers);
+        if (selected("slot"))
+          report<SlotQueue<N>, N>("slot", settings, producers, consumers);
+        if (selected("mutex"))
+          report<MutexDeque<N>, N>("mutex", settings, producers, consumers);
+#if defined(WILT_BENCH_BOOST)
+        if (selected("boost"))
+          report<BoostQueue<N>, N>("boost", settings, producers, consumers);
+#endif
+#if defined(WILT_BENCH_MOODYCAMEL)
+        if (selected("moodycamel"))
+          report<MoodyQueue<N>, N>("moodycamel", settings, producers, consumers);
+#endif
+      }
+    }
+  }
+
+  // Message sizes are template arguments, so only these sizes can be swept
+  void sweep(const Settings& settings, std::size_t size)
+  {
+    switch (size)
+    {
+    case 8:     sweep<8>(settings);     break;
+    case 16:    sweep<16>(settings);    break;
+    case 32:    sweep<32>(settings);    break;
+    case 64:    sweep<64>(settings);    break;
+    case 100:   sweep<100>(settings);   break;
+    case 128:   sweep<128>(settings);   break;
+    case 256:   sweep<256>(settings);   break;
+    case 512:   sweep<512>(settings);   break;
+    case 1000:  sweep<1000>(settings);  break;
+    case 1024:  sweep<1024>(settings);  break;
+    case 4096:  sweep<4096>(settings);  break;
+    case 16384: sweep<16384>(settings); break;
+    case 65536: sweep<65536>(settings); break;
+    default:
+      std::fprintf(stderr, "unsupported message size %zu\n", size);
+    }
+  }
+
+  template <class T>
+  std::vector<T> parse_list(const char* arg)
+  {
+    std::vector<T> values;
+    for (char* end; *arg != '\0'; arg = *end == ',' ? end + 1 : end)
+    {
+      values.push_back(static_cast<T>(std::strtoull(arg, &end, 10)));
+      if (end == arg)
+        break;
+    }
+
+    return values;
+  }
+
+  std::vector<std::string> parse_names(const char* arg)
+  {
+    std::vector<std::string> names;
+    std::string name;
+    for (; ; ++arg)
+    {
+      if (*arg == ',' || *arg == '\0')
+      {
+        if (!name.empty())
+          names.push_back(name);
+        name.clear();
+
+        if (*arg == '\0')
+          break;
+      }
+      else
+      {
+        name += *arg;
+      }
+    }
+
+    return names;
+  }
+
+  bool parse_wait(const char* arg, wilt::WaitStrategy& wait)
+  {
+    if (std::strcmp(arg, "spin") == 0)
+      wait = wilt::WaitStrategy::spin;
+    else if (std::strcmp(arg, "backoff") == 0)
+      wait = wilt::WaitStrategy::backoff;
+    else if (std::strcmp(arg, "block") == 0)
+      wait = wilt::WaitStrategy::block;
+    else
+      return false;
+
+    return true;
+  }
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+  Settings settings;
+  for (int i = 1; i < argc; ++i)
+  {
+    auto has_value = i + 1 < argc;
+    if (std::strcmp(argv[i], "--pin") == 0)
+      settings.pin = true;
+    else if (std::strcmp(argv[i], "-p") == 0 && has_value)
+      settings.producers = parse_list<int>(argv[++i]);
+    else if (std::strcmp(argv[i], "-c") == 0 && has_value)
+      settings.consumers = parse_list<int>(argv[++i]);
+    else if (std::strcmp(argv[i], "-s") == 0 && has_value)
+      settings.sizes = parse_list<std::size_t>(argv[++i]);
+    else if (std::strcmp(argv[i], "-q") == 0 && has_value)
+      settings.queues = parse_names(argv[++i]);
+    else if (std::strcmp(argv[i], "-b") == 0 && has_value)
+      settings.bytes = std::strtoull(argv[++i], nullptr, 10);
+    else if (std::strcmp(argv[i], "-r") == 0 && has_value)
+      settings.capacity = static_cast<std::size_t>(std::strtoull(argv[++i], nullptr, 10));
+    else if (std::strcmp(argv[i], "-w") == 0 && has_value && parse_wait(argv[i + 1], settings.options.wait))
+      ++i;
+    else
+    {
+      std::fprintf(stderr, "usage: %s [-p list] [-c list] [-s list] [-q list] [-b bytes] [-r bytes] [-w strategy] [--pin]\n", argv[0]);
+      return 1;
+    }
+  }
+
+  std::printf("%-10s %3s %3s %7s %12s %10s %10s %10s %10s\n",
+    "queue", "P", "C", "size", "msgs/s", "MB/s", "p50 ns", "p99 ns", "p99.9 ns");
+
+  for (auto size : settings.sizes)
+    sweep(settings, size);
+
+  return 0;
+}
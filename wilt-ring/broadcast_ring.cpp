@@ -0,0 +1,414 @@
+////////////////////////////////////////////////////////////////////////////////
+// FILE: broadcast_ring.cpp
+// DATE: 2026-10-14
+// AUTH: Trevor Wilson
+// DESC: Implements a lock-free ring buffer where every reader sees every element
+
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2016 Trevor Wilson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy 
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell 
+// copies of the Software, and to permit persons to whom the Software is 
+// furnished to do so, subject to the following conditions :
+// 
+//   The above copyright notice and this permission notice shall be included in
+//   all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE 
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "broadcast_ring.h"
+using namespace wilt;
+
+#include <cstdint>
+// - std::int64_t
+// - std::uintptr_t
+
+namespace
+{
+  // Value of mask_ when the capacity isn't a power of two
+  const std::uint64_t NO_MASK = ~static_cast<std::uint64_t>(0);
+
+  // Cursor position of a reader that isn't subscribed, it's larger than any
+  // real position so it never holds writers back
+  const std::uint64_t FREE = ~static_cast<std::uint64_t>(0);
+
+  // Deadline that has always passed, non-blocking helpers use it to check
+  // their conditions once
+  const BroadcastRing_::time_point IMMEDIATELY = BroadcastRing_::time_point::min();
+
+  // Sequence numbers of a slot holding a position. Writes in progress are
+  // only marked when overwriting, so readers can tell a torn copy
+  std::uint64_t published(std::uint64_t pos) { return 2 * pos + 2; }
+  std::uint64_t writing(std::uint64_t pos)   { return 2 * pos + 1; }
+
+  // Distance between two positions or sequence numbers, wrapping safely
+  std::int64_t distance(std::uint64_t a, std::uint64_t b)
+  {
+    return static_cast<std::int64_t>(a - b);
+  }
+
+} // namespace
+
+BroadcastRing_::BroadcastRing_()
+  : memory_(nullptr)
+  , cursors_(nullptr)
+  , slots_(nullptr)
+  , stride_(0)
+  , offset_(0)
+  , capacity_(0)
+  , readers_(0)
+  , mask_(NO_MASK)
+  , overwrite_(false)
+  , waiter_(WaitStrategy::spin)
+{
+  std::atomic_init(&lap_, static_cast<std::uint64_t>(0));
+  std::atomic_init(&wpos_, static_cast<std::uint64_t>(0));
+  std::atomic_init(&gate_, static_cast<std::uint64_t>(0));
+}
+
+BroadcastRing_::BroadcastRing_(std::size_t size, std::size_t stride, std::size_t offset, std::size_t alignment, std::size_t readers, bool overwrite, const RingOptions& options)
+  : memory_(nullptr)
+  , cursors_(nullptr)
+  , slots_(nullptr)
+  , stride_(stride)
+  , offset_(offset)
+  , capacity_(size)
+  , readers_(size != 0 ? readers : 0)
+  , mask_((size & (size - 1)) == 0 ? size - 1 : NO_MASK)
+  , overwrite_(overwrite)
+  , waiter_(options.wait)
+{
+  std::atomic_init(&lap_, static_cast<std::uint64_t>(0));
+  std::atomic_init(&wpos_, static_cast<std::uint64_t>(0));
+  std::atomic_init(&gate_, static_cast<std::uint64_t>(0));
+
+  if (size == 0)
+    return;
+
+  // The cursors come first, then the slots, each aligned as they need
+
+  auto cursors = readers_ * sizeof(cursor_);
+  memory_ = new char[cursors + alignof(cursor_) - 1 + size * stride + alignment - 1];
+  auto address = reinterpret_cast<std::uintptr_t>(memory_);
+  cursors_ = reinterpret_cast<cursor_*>(memory_ + (alignof(cursor_) - address % alignof(cursor_)) % alignof(cursor_));
+  address = reinterpret_cast<std::uintptr_t>(cursors_) + cursors;
+  slots_ = reinterpret_cast<char*>(address) + (alignment - address % alignment) % alignment;
+
+  for (std::size_t i = 0; i < readers_; ++i)
+  {
+    new(cursors_ + i) cursor_;
+    std::atomic_init(&cursors_[i].pos, FREE);
+  }
+
+  // Every slot starts as if it held the position a lap before its first
+  for (std::size_t i = 0; i < size; ++i)
+    new(slots_ + i * stride) sequence_(published(static_cast<std::uint64_t>(i) - size));
+}
+
+BroadcastRing_::BroadcastRing_(BroadcastRing_&& ring)
+  : memory_(ring.memory_)
+  , cursors_(ring.cursors_)
+  , slots_(ring.slots_)
+  , stride_(ring.stride_)
+  , offset_(ring.offset_)
+  , capacity_(ring.capacity_)
+  , readers_(ring.readers_)
+  , mask_(ring.mask_)
+  , overwrite_(ring.overwrite_)
+  , waiter_(ring.waiter_.strategy())
+{
+  std::atomic_init(&lap_, ring.lap_.load());
+  std::atomic_init(&wpos_, ring.wpos_.load());
+  std::atomic_init(&gate_, ring.gate_.load());
+
+  ring.reset_();
+}
+
+BroadcastRing_& BroadcastRing_::operator= (BroadcastRing_&& ring)
+{
+  deallocate_();
+
+  memory_ = ring.memory_;
+  cursors_ = ring.cursors_;
+  slots_ = ring.slots_;
+  stride_ = ring.stride_;
+  offset_ = ring.offset_;
+  capacity_ = ring.capacity_;
+  readers_ = ring.readers_;
+  mask_ = ring.mask_;
+  overwrite_ = ring.overwrite_;
+  waiter_.set_strategy(ring.waiter_.strategy());
+  lap_ = ring.lap_.load();
+  wpos_ = ring.wpos_.load();
+  gate_ = ring.gate_.load();
+
+  ring.reset_();
+
+  return *this;
+}
+
+BroadcastRing_::~BroadcastRing_()
+{
+  deallocate_();
+}
+
+std::size_t BroadcastRing_::capacity() const
+{
+  return capacity_;
+}
+
+std::size_t BroadcastRing_::max_readers() const
+{
+  return readers_;
+}
+
+std::size_t BroadcastRing_::readers() const
+{
+  std::size_t count = 0;
+  for (std::size_t i = 0; i < readers_; ++i)
+  {
+    if (cursors_[i].pos.load(std::memory_order_relaxed) != FREE)
+      ++count;
+  }
+
+  return count;
+}
+
+char* BroadcastRing_::acquire_write_slot_(std::uint64_t& pos)
+{
+  if (capacity_ == 0)                                       // no slots
+  {
+    waiter_.wait_until([]{ return false; }, nullptr);       // wait forever
+    return nullptr;
+  }
+
+  pos = wpos_.fetch_add(1, std::memory_order_relaxed);      // take ticket
+  auto slot = slot_(pos);
+  auto& seq = sequence_of_(slot);
+  waiter_.wait_until([&]{                                   // check slot
+    return seq.load(std::memory_order_acquire) == published(pos - capacity_) // wait until last lap written
+        && gate_open_(pos);                                 // and read
+  }, nullptr);
+
+  if (overwrite_)
+  {
+    seq.store(writing(pos), std::memory_order_relaxed);     // mark as torn
+    std::atomic_thread_fence(std::memory_order_release);
+  }
+
+  return slot + offset_;
+}
+
+char* BroadcastRing_::acquire_write_slot_(std::uint64_t& pos, const time_point* deadline)
+{
+  if (capacity_ == 0)
+    return nullptr;
+
+  auto wpos = wpos_.load(std::memory_order_relaxed);        // read position
+  while (true)                                              // loop while conflict
+  {
+    auto slot = slot_(wpos);
+    auto& seq = sequence_of_(slot);
+    auto diff = distance(seq.load(std::memory_order_acquire), published(wpos - capacity_));
+    if (diff == 0 && gate_open_(wpos))                      // slot is free
+    {
+      if (wpos_.compare_exchange_weak(wpos, wpos + 1, std::memory_order_relaxed)) // try take
+      {
+        if (overwrite_)
+        {
+          seq.store(writing(wpos), std::memory_order_relaxed); // mark as torn
+          std::atomic_thread_fence(std::memory_order_release);
+        }
+
+        pos = wpos;
+        return slot + offset_;                              // taken
+      }
+    }
+    else if (diff <= 0)                                     // slot not yet read
+    {
+      if (!waiter_.wait_until([&]{                          // check slot
+        return (seq.load(std::memory_order_acquire) == published(wpos - capacity_) && gate_open_(wpos)) // wait until read
+            || wpos_.load(std::memory_order_relaxed) != wpos; // or taken
+      }, deadline))
+        return nullptr;                                     // return timeout
+
+      wpos = wpos_.load(std::memory_order_relaxed);         // read position
+    }
+    else                                                    // taken by another
+    {
+      wpos = wpos_.load(std::memory_order_relaxed);         // read position
+    }
+  }
+}
+
+char* BroadcastRing_::try_acquire_write_slot_(std::uint64_t& pos)
+{
+  return acquire_write_slot_(pos, &IMMEDIATELY);
+}
+
+void BroadcastRing_::release_write_slot_(std::uint64_t pos)
+{
+  sequence_of_(slot_(pos)).store(published(pos), std::memory_order_release); // pass to readers
+  waiter_.notify();                                         // wake parked threads
+}
+
+std::size_t BroadcastRing_::subscribe_()
+{
+  // A writer that scans the cursors before this one is taken could still
+  // be overwriting the lap before the position first stored. The position
+  // is read again afterwards, which is at least where such a scan started,
+  // so every write the reader waits for saw it
+
+  for (std::size_t i = 0; i < readers_; ++i)
+  {
+    auto expected = FREE;
+    if (cursors_[i].pos.compare_exchange_strong(expected, wpos_.load()))
+    {
+      cursors_[i].pos.store(wpos_.load());
+      return i;
+    }
+  }
+
+  return NO_READER;
+}
+
+void BroadcastRing_::unsubscribe_(std::size_t reader)
+{
+  cursors_[reader].pos.store(FREE, std::memory_order_release); // stop holding writers
+  waiter_.notify();                                         // wake parked threads
+}
+
+char* BroadcastRing_::acquire_read_slot_(std::size_t reader, std::uint64_t& pos, std::uint64_t& dropped, const time_point* deadline)
+{
+  auto& cursor = cursors_[reader].pos;
+  pos = cursor.load(std::memory_order_relaxed);             // read cursor
+  while (true)                                              // loop while overwritten
+  {
+    auto slot = slot_(pos);
+    auto& seq = sequence_of_(slot);
+    std::uint64_t current;
+    if (!waiter_.wait_until([&]{                            // check slot
+      current = seq.load(std::memory_order_acquire);
+      return distance(current, published(pos)) >= 0;       // wait until written
+    }, deadline))
+      return nullptr;                                       // return timeout
+
+    if (current == published(pos))
+      return slot + offset_;                                // ready
+
+    // The slot holds a later lap, so the writers are more than a lap ahead
+    // and the oldest position left is a lap behind the write position. The
+    // lap in the slot bounds it too, in case the write position read is
+    // older than the slot
+
+    auto held = (current - 1) / 2;
+    auto oldest = wpos_.load(std::memory_order_relaxed) - capacity_;
+    if (distance(oldest, held - capacity_ + 1) < 0)
+      oldest = held - capacity_ + 1;
+    dropped += oldest - pos;
+    pos = oldest;                                           // skip ahead
+    cursor.store(pos, std::memory_order_relaxed);
+  }
+}
+
+char* BroadcastRing_::try_acquire_read_slot_(std::size_t reader, std::uint64_t& pos, std::uint64_t& dropped)
+{
+  return acquire_read_slot_(reader, pos, dropped, &IMMEDIATELY);
+}
+
+bool BroadcastRing_::read_slot_valid_(std::uint64_t pos)
+{
+  std::atomic_thread_fence(std::memory_order_acquire);
+  return sequence_of_(slot_(pos)).load(std::memory_order_relaxed) == published(pos);
+}
+
+void BroadcastRing_::release_read_slot_(std::size_t reader, std::uint64_t pos)
+{
+  cursors_[reader].pos.store(pos + 1, std::memory_order_release); // pass to writers
+  waiter_.notify();                                         // wake parked threads
+}
+
+std::size_t BroadcastRing_::lag_(std::size_t reader) const
+{
+  auto pos = cursors_[reader].pos.load();
+  auto wpos = wpos_.load();
+  if (wpos <= pos)
+    return 0;
+
+  auto lag = static_cast<std::size_t>(wpos - pos);
+  return overwrite_ && lag > capacity_ ? capacity_ : lag;
+}
+
+char* BroadcastRing_::written_slot_(std::uint64_t pos)
+{
+  auto slot = slot_(pos);
+  if (sequence_of_(slot).load() != published(pos))
+    return nullptr;
+
+  return slot + offset_;
+}
+
+void BroadcastRing_::deallocate_()
+{
+  delete[] memory_;
+  memory_ = nullptr;
+  cursors_ = nullptr;
+  slots_ = nullptr;
+}
+
+void BroadcastRing_::reset_()
+{
+  memory_ = nullptr;
+  cursors_ = nullptr;
+  slots_ = nullptr;
+  capacity_ = 0;
+  readers_ = 0;
+  lap_ = 0;
+  wpos_ = 0;
+  gate_ = 0;
+}
+
+char* BroadcastRing_::slot_(std::uint64_t pos)
+{
+  auto index = mask_ != NO_MASK ? pos & mask_ : detail::wrap(pos, capacity_, lap_);
+  return slots_ + static_cast<std::size_t>(index) * stride_;
+}
+
+BroadcastRing_::sequence_& BroadcastRing_::sequence_of_(char* slot)
+{
+  return *reinterpret_cast<sequence_*>(slot);
+}
+
+bool BroadcastRing_::gate_open_(std::uint64_t pos)
+{
+  if (overwrite_)
+    return true;
+
+  auto capacity = static_cast<std::int64_t>(capacity_);
+  if (distance(pos, gate_.load(std::memory_order_acquire)) < capacity)
+    return true;
+
+  // The gate starts at the write position so that it's still valid for
+  // readers subscribing during the scan (see subscribe_)
+
+  auto gate = wpos_.load();
+  for (std::size_t i = 0; i < readers_; ++i)
+  {
+    auto cursor = cursors_[i].pos.load();
+    if (cursor < gate)
+      gate = cursor;
+  }
+
+  gate_.store(gate, std::memory_order_release);
+  return distance(pos, gate) < capacity;
+}
@@ -0,0 +1,755 @@
+////////////////////////////////////////////////////////////////////////////////
+// FILE: broadcast_ring.h
+// DATE: 2026-10-14
+// AUTH: Trevor Wilson
+// DESC: Defines a lock-free ring buffer where every reader sees every element
+
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2016 Trevor Wilson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+//   The above copyright notice and this permission notice shall be included in
+//   all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef WILT_BROADCAST_RING_H
+#define WILT_BROADCAST_RING_H
+
+#include <atomic>
+// - std::atomic
+#include <chrono>
+// - std::chrono::steady_clock
+// - std::chrono::duration
+#include <cstddef>
+// - std::size_t
+#include <cstdint>
+// - std::uint64_t
+#include <cstring>
+// - std::memcpy
+#include <new>
+// - operator new
+#include <type_traits>
+// - std::is_copy_assignable
+// - std::is_nothrow_copy_assignable
+// - std::is_nothrow_copy_constructible
+// - std::is_nothrow_move_constructible
+// - std::is_nothrow_destructible
+// - std::is_same
+// - std::is_trivially_copyable
+// - std::is_trivially_destructible
+#include <utility>
+// - std::forward
+// - std::move
+
+#include "ring.h"
+// - wilt::RingOptions
+// - wilt::WaitStrategy
+// - wilt::detail::Waiter
+// - wilt::detail::wrap
+// - wilt::overflow
+
+namespace wilt
+{
+  //////////////////////////////////////////////////////////////////////////////
+  // This structure is a ring buffer where every reader sees every element,
+  // instead of each element going to exactly one reader. Elements are written
+  // once, and each reader has its own cursor: the position of the next
+  // element it will read. Space is reclaimed once the slowest cursor has
+  // passed it, so a ring feeding N readers costs one copy and one reservation
+  // per element rather than one per reader.
+  //
+  // Like SlotRing_, each slot has a sequence number, here saying which
+  // position it holds and whether that position is fully written. Writers
+  // take positions with a fetch-add and wait on their own slot, readers wait
+  // for the sequence of their next position and never touch each other's
+  // cursors. Writers only scan the cursors when their cached copy of the
+  // slowest one shows the ring as full.
+  //
+  //   pos    0 1 2 3 4 5 6 7
+  //   slot   8 9 2 3 4 5 6 7
+  //              |A    |B  |wpos
+  //
+  // The diagram above shows a ring of 8 slots after 10 writes, with reader A
+  // two elements in and reader B five. The next write has to wait for A.
+  //
+  // Readers subscribe to get a cursor, up to the number given at
+  // construction, and start at the next position written. Elements written
+  // while nobody is subscribed are simply overwritten. With overflow::
+  // overwrite, writers never wait for readers and readers that fall a full
+  // ring behind skip to the oldest element left, counting what they missed.
+  // They copy elements out and check the sequence afterwards to detect that
+  // the slot was overwritten meanwhile, so elements must be trivially
+  // copyable.
+  //
+  // A ring without slots has no cursors to subscribe to, and blocking writes
+  // to it wait forever like those of a Ring<T> without a buffer.
+  //
+  // Only the wait strategy and power_of_two options are used. BroadcastRing_
+  // is the untyped engine, BroadcastRing<T> constructs and destroys the
+  // elements.
+
+  class BroadcastRing_
+  {
+  public:
+    ////////////////////////////////////////////////////////////////////////////
+    // TYPE DEFINITIONS
+    ////////////////////////////////////////////////////////////////////////////
+
+    typedef std::chrono::steady_clock::time_point time_point;
+
+  protected:
+
+    // Returned by subscribe_() when every cursor is taken
+    static const std::size_t NO_READER = ~static_cast<std::size_t>(0);
+
+  private:
+
+    typedef std::atomic<std::uint64_t> sequence_;
+
+    // Cursors each get a cache line, since their readers update them on
+    // every read
+    struct alignas(64) cursor_
+    {
+      std::atomic<std::uint64_t> pos; // next position to read, or FREE
+    };
+
+  private:
+    ////////////////////////////////////////////////////////////////////////////
+    // PRIVATE MEMBERS
+    ////////////////////////////////////////////////////////////////////////////
+    // Each slot is its sequence number followed by the element, at 'offset_'.
+    // The cursors precede the slots in the same allocation.
+
+    char*         memory_;    // allocation holding the cursors and slots
+    cursor_*      cursors_;   // one per possible reader
+    char*         slots_;     // first slot, aligned for the element
+    std::size_t   stride_;    // size of a slot
+    std::size_t   offset_;    // offset of the element in a slot
+    std::size_t   capacity_;  // number of slots
+    std::size_t   readers_;   // number of cursors
+    std::uint64_t mask_;      // wraps positions if the capacity is a power of two
+    bool          overwrite_; // writes don't wait for readers
+    std::atomic<std::uint64_t> lap_; // start of a recent lap, wraps positions
+
+    alignas(64)
+    std::atomic<std::uint64_t> wpos_; // position of the next write
+    std::atomic<std::uint64_t> gate_; // copy of the slowest cursor
+
+    detail::Waiter waiter_; // how blocking operations wait
+
+  public:
+    ////////////////////////////////////////////////////////////////////////////
+    // CONSTRUCTORS AND DESTRUCTORS
+    ////////////////////////////////////////////////////////////////////////////
+
+    // Constructs a ring without slots (capacity() == 0)
+    BroadcastRing_();
+
+    // Constructs a ring with 'size' slots of 'stride' bytes, with elements
+    // aligned to 'alignment' at 'offset' in each slot, for up to 'readers'
+    // readers at once
+    BroadcastRing_(std::size_t size, std::size_t stride, std::size_t offset, std::size_t alignment, std::size_t readers, bool overwrite, const RingOptions& options);
+
+    // Moves the slots between rings, assumes no concurrent operations and no
+    // subscribed readers
+    BroadcastRing_(BroadcastRing_&& ring);
+
+    // Moves the slots between rings, assumes no concurrent operations and no
+    // subscribed readers on either ring. Deallocates the slots
+    BroadcastRing_& operator= (BroadcastRing_&& ring);
+
+    // No copying
+    BroadcastRing_(const BroadcastRing_&)             = delete;
+    BroadcastRing_& operator= (const BroadcastRing_&) = delete;
+
+    // Deallocates the slots, doesn't destruct elements
+    ~BroadcastRing_();
+
+  public:
+    ////////////////////////////////////////////////////////////////////////////
+    // QUERY FUNCTIONS
+    ////////////////////////////////////////////////////////////////////////////
+    // Functions only report on the state of the ring
+
+    // Maximum number of elements that can be held
+    std::size_t capacity() const;
+
+    // Maximum number of readers subscribed at once
+    std::size_t max_readers() const;
+
+    // Returns the number of readers currently subscribed
+    std::size_t readers() const;
+
+  protected:
+    ////////////////////////////////////////////////////////////////////////////
+    // PROTECTED FUNCTIONS
+    ////////////////////////////////////////////////////////////////////////////
+
+    // Takes a position and waits for its slot, returning the element storage.
+    // The slot may still hold the element a lap earlier if 'pos' is at least
+    // capacity(). The timed versions take the position only once the slot is
+    // ready and return nullptr if the deadline passes first (or immediately
+    // for the try versions). Releasing publishes the element to readers
+    char* acquire_write_slot_(std::uint64_t& pos);
+    char* acquire_write_slot_(std::uint64_t& pos, const time_point* deadline);
+    char* try_acquire_write_slot_(std::uint64_t& pos);
+    void  release_write_slot_(std::uint64_t pos);
+
+    // Takes a cursor starting at the next position written, or returns
+    // NO_READER if all are taken. Unsubscribing frees it for another reader
+    std::size_t subscribe_();
+    void        unsubscribe_(std::size_t reader);
+
+    // Waits for the element at the reader's cursor, setting 'pos' to its
+    // position and returning its storage, or nullptr if the deadline passes
+    // first. When overwriting, readers a full ring behind first skip ahead
+    // and add the positions skipped to 'dropped', and the element must be
+    // checked with read_slot_valid_() after copying it. Releasing moves the
+    // cursor past the element
+    char* acquire_read_slot_(std::size_t reader, std::uint64_t& pos, std::uint64_t& dropped, const time_point* deadline = nullptr);
+    char* try_acquire_read_slot_(std::size_t reader, std::uint64_t& pos, std::uint64_t& dropped);
+    bool  read_slot_valid_(std::uint64_t pos);
+    void  release_read_slot_(std::size_t reader, std::uint64_t pos);
+
+    // Returns the number of elements written that the reader hasn't read,
+    // including writes in progress, at most capacity() when overwriting
+    std::size_t lag_(std::size_t reader) const;
+
+    // Returns the element storage of a written position, or nullptr, assumes
+    // no concurrent operations
+    char* written_slot_(std::uint64_t pos);
+
+    std::uint64_t end_data_() const { return wpos_.load(); }
+
+  private:
+    ////////////////////////////////////////////////////////////////////////////
+    // PRIVATE HELPER FUNCTIONS
+    ////////////////////////////////////////////////////////////////////////////
+
+    void       deallocate_();
+    void       reset_();
+    char*      slot_(std::uint64_t pos);
+    sequence_& sequence_of_(char* slot);
+
+    // Returns whether every reader is done with the slot of 'pos' a lap
+    // earlier, scanning the cursors only if the cached gate says not
+    bool gate_open_(std::uint64_t pos);
+
+  }; // class BroadcastRing_
+
+  //////////////////////////////////////////////////////////////////////////////
+  // Typed wrapper around BroadcastRing_. Writers write as they would to a
+  // SlotRing<T>; readers subscribe() and read through their Reader, which
+  // copies elements instead of moving them since other readers still need
+  // them. Elements stay in their slot until a write reuses it or the ring is
+  // destroyed. The overflow tag selects whether writers wait for the slowest
+  // reader or overwrite (see BroadcastRing_).
+
+  template <class T, class O = overflow::block>
+  class BroadcastRing : protected BroadcastRing_
+  {
+  public:
+    ////////////////////////////////////////////////////////////////////////////
+    // TYPE DEFINITIONS
+    ////////////////////////////////////////////////////////////////////////////
+
+    typedef BroadcastRing_::time_point time_point;
+
+  private:
+
+    static const bool OVERWRITE = std::is_same<O, overflow::overwrite>::value;
+
+    static_assert(!OVERWRITE || std::is_trivially_copyable<T>::value, "T must be trivially copyable to overwrite");
+
+    // The element follows the sequence number, aligned for both
+
+    static const std::size_t ALIGNMENT = alignof(T) > alignof(std::atomic<std::uint64_t>) ? alignof(T) : alignof(std::atomic<std::uint64_t>);
+    static const std::size_t OFFSET    = (sizeof(std::atomic<std::uint64_t>) + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+    static const std::size_t STRIDE    = (OFFSET + sizeof(T) + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+
+  public:
+    ////////////////////////////////////////////////////////////////////////////
+    // READERS
+    ////////////////////////////////////////////////////////////////////////////
+    // A reader holds a cursor and is used by one thread at a time. It frees
+    // the cursor when destroyed, and must not outlive the ring.
+
+    class Reader
+    {
+    public:
+      // Constructs an empty reader (holds no cursor)
+      Reader();
+
+      // Moves the cursor between readers
+      Reader(Reader&& reader);
+      Reader& operator= (Reader&& reader);
+
+      // No copying
+      Reader(const Reader&)             = delete;
+      Reader& operator= (const Reader&) = delete;
+
+      // Unsubscribes if subscribed
+      ~Reader();
+
+      explicit operator bool() const { return ring_ != nullptr; }
+
+      // Returns the number of elements written but not yet read by this
+      // reader, and the number it skipped because they were overwritten
+      std::size_t   lag() const;
+      std::uint64_t dropped() const { return dropped_; }
+
+      // Blocking operations run until an element is read. Non-blocking
+      // operations fail if there is no new element. A copy that throws
+      // leaves the element unread
+
+      void read(T& data) noexcept(std::is_nothrow_copy_assignable<T>::value);
+      bool try_read(T& data) noexcept(std::is_nothrow_copy_assignable<T>::value);
+
+      template <class Rep, class Period>
+      bool read_for(T& data, const std::chrono::duration<Rep, Period>& timeout) noexcept(std::is_nothrow_copy_assignable<T>::value);
+      bool read_until(T& data, time_point deadline) noexcept(std::is_nothrow_copy_assignable<T>::value);
+
+      // Calls 'f' with a const reference to the element in its slot. 'f' must
+      // not throw. Not available when overwriting, since the slot could be
+      // overwritten while 'f' looks at it
+
+      template <class F>
+      void consume(F&& f) noexcept;
+      template <class F>
+      bool try_consume(F&& f) noexcept;
+
+    private:
+      friend class BroadcastRing;
+      Reader(BroadcastRing* ring, std::size_t index);
+
+      bool read_(T& data, const time_point* deadline, bool blocking);
+
+      BroadcastRing* ring_;
+      std::size_t    index_;
+      std::uint64_t  dropped_;
+
+    }; // class Reader
+
+  public:
+    ////////////////////////////////////////////////////////////////////////////
+    // CONSTRUCTORS AND DESTRUCTORS
+    ////////////////////////////////////////////////////////////////////////////
+
+    // Constructs a ring without slots (capacity() == 0)
+    BroadcastRing();
+
+    // Constructs a ring with a number of slots for up to 'readers' readers
+    BroadcastRing(std::size_t size, std::size_t readers);
+    BroadcastRing(std::size_t size, std::size_t readers, const RingOptions& options);
+
+    // Moves the slots between rings, assumes no concurrent operations and no
+    // subscribed readers
+    BroadcastRing(BroadcastRing&& ring);
+
+    // Moves the slots between rings, assumes no concurrent operations and no
+    // subscribed readers on either ring. Deallocates the slots
+    BroadcastRing& operator= (BroadcastRing&& ring);
+
+    // No copying
+    BroadcastRing(const BroadcastRing&)             = delete;
+    BroadcastRing& operator= (const BroadcastRing&) = delete;
+
+    // Deallocates the slots, destructs stored data.
+    ~BroadcastRing();
+
+  public:
+    ////////////////////////////////////////////////////////////////////////////
+    // QUERY FUNCTIONS
+    ////////////////////////////////////////////////////////////////////////////
+    // Functions only report on the state of the ring
+
+    using BroadcastRing_::capacity;
+    using BroadcastRing_::max_readers;
+    using BroadcastRing_::readers;
+
+  public:
+    ////////////////////////////////////////////////////////////////////////////
+    // ACCESSORS AND MODIFIERS
+    ////////////////////////////////////////////////////////////////////////////
+    // All operations assume object has not been moved. Blocking operations run
+    // until operation is completed. Non-blocking operations fail if the next
+    // slot isn't ready. Writes of a T whose copy can throw copy it before
+    // taking a slot, so only its move must not throw
+
+    // Returns a reader starting at the next element written, or an empty
+    // reader if max_readers() are already subscribed
+    Reader subscribe() noexcept;
+
+    void write(const T& data) noexcept(std::is_nothrow_copy_constructible<T>::value);
+    void write(T&& data) noexcept;
+    bool try_write(const T& data) noexcept(std::is_nothrow_copy_constructible<T>::value);
+    bool try_write(T&& data) noexcept;
+
+    template <class Rep, class Period>
+    bool write_for(const T& data, const std::chrono::duration<Rep, Period>& timeout) noexcept(std::is_nothrow_copy_constructible<T>::value);
+    template <class Rep, class Period>
+    bool write_for(T&& data, const std::chrono::duration<Rep, Period>& timeout) noexcept;
+    bool write_until(const T& data, time_point deadline) noexcept(std::is_nothrow_copy_constructible<T>::value);
+    bool write_until(T&& data, time_point deadline) noexcept;
+
+  private:
+    ////////////////////////////////////////////////////////////////////////////
+    // PRIVATE HELPER FUNCTIONS
+    ////////////////////////////////////////////////////////////////////////////
+
+    void destruct_();
+
+    // Destructs the element a lap earlier if there is one and constructs the
+    // new one, then publishes it
+    template <class U>
+    void store_(char* slot, std::uint64_t pos, U&& data);
+
+    static std::size_t round_size_(std::size_t size, const RingOptions& options);
+
+  }; // class BroadcastRing<T>
+
+  template <class T, class O>
+  BroadcastRing<T, O>::Reader::Reader()
+    : ring_(nullptr)
+    , index_(NO_READER)
+    , dropped_(0)
+  { }
+
+  template <class T, class O>
+  BroadcastRing<T, O>::Reader::Reader(BroadcastRing* ring, std::size_t index)
+    : ring_(ring)
+    , index_(index)
+    , dropped_(0)
+  { }
+
+  template <class T, class O>
+  BroadcastRing<T, O>::Reader::Reader(Reader&& reader)
+    : ring_(reader.ring_)
+    , index_(reader.index_)
+    , dropped_(reader.dropped_)
+  {
+    reader.ring_ = nullptr;
+  }
+
+  template <class T, class O>
+  typename BroadcastRing<T, O>::Reader& BroadcastRing<T, O>::Reader::operator= (Reader&& reader)
+  {
+    if (ring_ != nullptr)
+      ring_->unsubscribe_(index_);
+
+    ring_ = reader.ring_;
+    index_ = reader.index_;
+    dropped_ = reader.dropped_;
+    reader.ring_ = nullptr;
+
+    return *this;
+  }
+
+  template <class T, class O>
+  BroadcastRing<T, O>::Reader::~Reader()
+  {
+    if (ring_ != nullptr)
+      ring_->unsubscribe_(index_);
+  }
+
+  template <class T, class O>
+  std::size_t BroadcastRing<T, O>::Reader::lag() const
+  {
+    return ring_ != nullptr ? ring_->lag_(index_) : 0;
+  }
+
+  template <class T, class O>
+  bool BroadcastRing<T, O>::Reader::read_(T& data, const time_point* deadline, bool blocking)
+  {
+    static_assert(std::is_copy_assignable<T>::value, "T must be copy assignable");
+
+    while (true)
+    {
+      std::uint64_t pos;
+      auto t = reinterpret_cast<const T*>(blocking
+        ? ring_->acquire_read_slot_(index_, pos, dropped_, deadline)
+        : ring_->try_acquire_read_slot_(index_, pos, dropped_));
+      if (t == nullptr)
+        return false;
+
+      // critical section
+      if (OVERWRITE)
+      {
+        // An overwritten element is skipped on the next try like any other
+        // the reader fell behind on. The copy only reaches 'data' once it's
+        // known not to be torn
+
+        alignas(T) unsigned char copy[sizeof(T)];
+        std::memcpy(copy, t, sizeof(T));
+        if (!ring_->read_slot_valid_(pos))
+          continue;
+
+        std::memcpy(static_cast<void*>(&data), copy, sizeof(T));
+      }
+      else
+      {
+        data = *t;
+      }
+
+      ring_->release_read_slot_(index_, pos);
+      return true;
+    }
+  }
+
+  template <class T, class O>
+  void BroadcastRing<T, O>::Reader::read(T& data) noexcept(std::is_nothrow_copy_assignable<T>::value)
+  {
+    read_(data, nullptr, true);
+  }
+
+  template <class T, class O>
+  bool BroadcastRing<T, O>::Reader::try_read(T& data) noexcept(std::is_nothrow_copy_assignable<T>::value)
+  {
+    return read_(data, nullptr, false);
+  }
+
+  template <class T, class O>
+  template <class Rep, class Period>
+  bool BroadcastRing<T, O>::Reader::read_for(T& data, const std::chrono::duration<Rep, Period>& timeout) noexcept(std::is_nothrow_copy_assignable<T>::value)
+  {
+    return read_until(data, std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(timeout));
+  }
+
+  template <class T, class O>
+  bool BroadcastRing<T, O>::Reader::read_until(T& data, time_point deadline) noexcept(std::is_nothrow_copy_assignable<T>::value)
+  {
+    return read_(data, &deadline, true);
+  }
+
+  template <class T, class O>
+  template <class F>
+  void BroadcastRing<T, O>::Reader::consume(F&& f) noexcept
+  {
+    static_assert(!OVERWRITE, "consume is not available when overwriting");
+
+    std::uint64_t pos;
+    auto t = reinterpret_cast<const T*>(ring_->acquire_read_slot_(index_, pos, dropped_));
+
+    // critical section
+    f(*t);
+
+    ring_->release_read_slot_(index_, pos);
+  }
+
+  template <class T, class O>
+  template <class F>
+  bool BroadcastRing<T, O>::Reader::try_consume(F&& f) noexcept
+  {
+    static_assert(!OVERWRITE, "consume is not available when overwriting");
+
+    std::uint64_t pos;
+    auto t = reinterpret_cast<const T*>(ring_->try_acquire_read_slot_(index_, pos, dropped_));
+    if (t == nullptr)
+      return false;
+
+    // critical section
+    f(*t);
+
+    ring_->release_read_slot_(index_, pos);
+    return true;
+  }
+
+  template <class T, class O>
+  BroadcastRing<T, O>::BroadcastRing()
+    : BroadcastRing_()
+  { }
+
+  template <class T, class O>
+  BroadcastRing<T, O>::BroadcastRing(std::size_t size, std::size_t readers)
+    : BroadcastRing_(size, STRIDE, OFFSET, ALIGNMENT, readers, OVERWRITE, RingOptions())
+  { }
+
+  template <class T, class O>
+  BroadcastRing<T, O>::BroadcastRing(std::size_t size, std::size_t readers, const RingOptions& options)
+    : BroadcastRing_(round_size_(size, options), STRIDE, OFFSET, ALIGNMENT, readers, OVERWRITE, options)
+  { }
+
+  template <class T, class O>
+  BroadcastRing<T, O>::BroadcastRing(BroadcastRing&& ring)
+    : BroadcastRing_(std::move(ring))
+  { }
+
+  template <class T, class O>
+  BroadcastRing<T, O>& BroadcastRing<T, O>::operator= (BroadcastRing&& ring)
+  {
+    destruct_();
+
+    BroadcastRing_::operator= (std::move(ring));
+
+    return *this;
+  }
+
+  template <class T, class O>
+  BroadcastRing<T, O>::~BroadcastRing()
+  {
+    destruct_();
+  }
+
+  template <class T, class O>
+  std::size_t BroadcastRing<T, O>::round_size_(std::size_t size, const RingOptions& options)
+  {
+    if (!options.power_of_two || size == 0)
+      return size;
+
+    std::size_t rounded = 1;
+    while (rounded < size)
+      rounded <<= 1;
+
+    return rounded;
+  }
+
+  template <class T, class O>
+  void BroadcastRing<T, O>::destruct_()
+  {
+    if (std::is_trivially_destructible<T>::value)
+      return;
+
+    auto end = end_data_();
+    auto pos = end > capacity() ? end - capacity() : 0;
+    for (; pos < end; ++pos)
+    {
+      auto slot = written_slot_(pos);
+      if (slot != nullptr)
+        reinterpret_cast<T*>(slot)->~T();
+    }
+  }
+
+  template <class T, class O>
+  template <class U>
+  void BroadcastRing<T, O>::store_(char* slot, std::uint64_t pos, U&& data)
+  {
+    static_assert(std::is_nothrow_destructible<T>::value, "T destructor must not throw");
+
+    // critical section
+    if (pos >= capacity())
+      reinterpret_cast<T*>(slot)->~T();
+    new(slot) T(std::forward<U>(data));
+
+    release_write_slot_(pos);
+  }
+
+  template <class T, class O>
+  typename BroadcastRing<T, O>::Reader BroadcastRing<T, O>::subscribe() noexcept
+  {
+    auto index = subscribe_();
+    if (index == NO_READER)
+      return Reader();
+
+    return Reader(this, index);
+  }
+
+  template <class T, class O>
+  void BroadcastRing<T, O>::write(const T& data) noexcept(std::is_nothrow_copy_constructible<T>::value)
+  {
+    if (!std::is_nothrow_copy_constructible<T>::value)
+      return write(T(data));
+
+    std::uint64_t pos;
+    auto slot = acquire_write_slot_(pos);
+    store_(slot, pos, data);
+  }
+
+  template <class T, class O>
+  void BroadcastRing<T, O>::write(T&& data) noexcept
+  {
+    static_assert(std::is_nothrow_move_constructible<T>::value, "T move constructor must not throw");
+
+    std::uint64_t pos;
+    auto slot = acquire_write_slot_(pos);
+    store_(slot, pos, std::move(data));
+  }
+
+  template <class T, class O>
+  bool BroadcastRing<T, O>::try_write(const T& data) noexcept(std::is_nothrow_copy_constructible<T>::value)
+  {
+    if (!std::is_nothrow_copy_constructible<T>::value)
+      return try_write(T(data));
+
+    std::uint64_t pos;
+    auto slot = try_acquire_write_slot_(pos);
+    if (slot == nullptr)
+      return false;
+
+    store_(slot, pos, data);
+    return true;
+  }
+
+  template <class T, class O>
+  bool BroadcastRing<T, O>::try_write(T&& data) noexcept
+  {
+    static_assert(std::is_nothrow_move_constructible<T>::value, "T move constructor must not throw");
+
+    std::uint64_t pos;
+    auto slot = try_acquire_write_slot_(pos);
+    if (slot == nullptr)
+      return false;
+
+    store_(slot, pos, std::move(data));
+    return true;
+  }
+
+  template <class T, class O>
+  template <class Rep, class Period>
+  bool BroadcastRing<T, O>::write_for(const T& data, const std::chrono::duration<Rep, Period>& timeout) noexcept(std::is_nothrow_copy_constructible<T>::value)
+  {
+    return write_until(data, std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(timeout));
+  }
+
+  template <class T, class O>
+  template <class Rep, class Period>
+  bool BroadcastRing<T, O>::write_for(T&& data, const std::chrono::duration<Rep, Period>& timeout) noexcept
+  {
+    return write_until(std::move(data), std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(timeout));
+  }
+
+  template <class T, class O>
+  bool BroadcastRing<T, O>::write_until(const T& data, time_point deadline) noexcept(std::is_nothrow_copy_constructible<T>::value)
+  {
+    if (!std::is_nothrow_copy_constructible<T>::value)
+      return write_until(T(data), deadline);
+
+    std::uint64_t pos;
+    auto slot = acquire_write_slot_(pos, &deadline);
+    if (slot == nullptr)
+      return false;
+
+    store_(slot, pos, data);
+    return true;
+  }
+
+  template <class T, class O>
+  bool BroadcastRing<T, O>::write_until(T&& data, time_point deadline) noexcept
+  {
+    static_assert(std::is_nothrow_move_constructible<T>::value, "T move constructor must not throw");
+
+    std::uint64_t pos;
+    auto slot = acquire_write_slot_(pos, &deadline);
+    if (slot == nullptr)
+      return false;
+
+    store_(slot, pos, std::move(data));
+    return true;
+  }
+
+} // namespace wilt
+
+#endif // !WILT_BROADCAST_RING_H
@@ -0,0 +1,103 @@
+////////////////////////////////////////////////////////////////////////////////
+// FILE: growable_ring.cpp
+// DATE: 2026-10-14
+// AUTH: Trevor Wilson
+// DESC: Implements the epochs and waiting of a growable ring
+
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2016 Trevor Wilson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy 
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell 
+// copies of the Software, and to permit persons to whom the Software is 
+// furnished to do so, subject to the following conditions :
+// 
+//   The above copyright notice and this permission notice shall be included in
+//   all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE 
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "growable_ring.h"
+using namespace wilt;
+
+#include <functional>
+// - std::hash
+#include <thread>
+// - std::thread
+// - std::this_thread::get_id
+
+GrowableRing_::GrowableRing_(WaitStrategy wait)
+  : waiter_(wait)
+{
+  for (auto& stripe : stripes_)
+  {
+    std::atomic_init(&stripe.active[0], static_cast<std::int64_t>(0));
+    std::atomic_init(&stripe.active[1], static_cast<std::int64_t>(0));
+  }
+  std::atomic_init(&epoch_, static_cast<std::uint64_t>(0));
+}
+
+GrowableRing_::GrowableRing_(GrowableRing_&& ring)
+  : GrowableRing_(ring.waiter_.strategy())
+{ }
+
+GrowableRing_& GrowableRing_::operator= (GrowableRing_&& ring)
+{
+  waiter_.set_strategy(ring.waiter_.strategy());
+
+  return *this;
+}
+
+std::size_t GrowableRing_::enter_()
+{
+  // The counter is raised before the segment pointers are loaded, so either
+  // a grace period sees the operation or the operation sees the pointers the
+  // grace period was started for
+
+  auto stripe = std::hash<std::thread::id>()(std::this_thread::get_id()) % STRIPES;
+  auto parity = static_cast<std::size_t>(epoch_.load() & 1);
+  stripes_[stripe].active[parity].fetch_add(1);
+
+  return stripe * 2 + parity;
+}
+
+void GrowableRing_::exit_(std::size_t token)
+{
+  stripes_[token / 2].active[token % 2].fetch_sub(1, std::memory_order_release);
+}
+
+void GrowableRing_::synchronize_()
+{
+  // Each flip sends new operations to the other counter so the old one can
+  // drain. Operations that read the epoch before a flip but counted
+  // themselves after the wait may land in either counter, so both are
+  // waited on
+
+  std::lock_guard<std::mutex> lock(grace_lock_);
+  for (auto flip = 0; flip < 2; ++flip)
+  {
+    auto parity = static_cast<std::size_t>(epoch_.fetch_add(1) & 1);
+    for (auto i = 0; ; ++i)
+    {
+      std::int64_t active = 0;
+      for (auto& stripe : stripes_)
+        active += stripe.active[parity].load();
+      if (active == 0)
+        break;
+
+      if (i < detail::Waiter::SPIN_LIMIT)
+        detail::Waiter::relax();
+      else
+        std::this_thread::yield();
+    }
+  }
+}
@@ -0,0 +1,623 @@
+////////////////////////////////////////////////////////////////////////////////
+// FILE: growable_ring.h
+// DATE: 2026-10-14
+// AUTH: Trevor Wilson
+// DESC: Defines a queue of linked ring segments that grows and shrinks online
+
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2016 Trevor Wilson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+//   The above copyright notice and this permission notice shall be included in
+//   all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef WILT_GROWABLE_RING_H
+#define WILT_GROWABLE_RING_H
+
+#include <atomic>
+// - std::atomic
+#include <chrono>
+// - std::chrono::steady_clock
+// - std::chrono::duration
+#include <cstddef>
+// - std::size_t
+#include <cstdint>
+// - std::int64_t
+// - std::uint64_t
+// - std::uintptr_t
+#include <mutex>
+// - std::mutex
+// - std::lock_guard
+#include <new>
+// - operator new
+#include <type_traits>
+// - std::is_nothrow_copy_constructible
+#include <utility>
+// - std::forward
+// - std::move
+
+#include "ring.h"
+// - wilt::Ring
+// - wilt::RingOptions
+// - wilt::WaitStrategy
+// - wilt::detail::Waiter
+
+namespace wilt
+{
+  //////////////////////////////////////////////////////////////////////////////
+  // This structure is a queue made of a chain of rings, called segments, so
+  // that its capacity can change while it's in use. Writers write to the
+  // last segment and readers read from the first. When the last segment is
+  // full, a writer links a new one twice its size (up to the maximum
+  // capacity) and later writes go there. The old segment is sealed once no
+  // write can still be adding to it. Readers move on from a sealed segment
+  // once they've emptied it, and it's freed once no read can still be in it.
+  // resize() links a segment of any size the same way, to grow or shrink.
+  //
+  //   head                        tail
+  //   [ 8, sealed ] -> [ 16, sealed ] -> [ 32 ]
+  //
+  // The diagram above shows a queue that grew twice, with readers still
+  // draining the first segment. Elements are read in the order of their
+  // segments, so each writer's elements stay in order.
+  //
+  // Operations run inside a read-side critical section that counts them in
+  // one of several striped counters, chosen by thread, for the current epoch.
+  // Sealing and freeing wait out a grace period: they flip the epoch and wait
+  // for the operations counted in the old one to finish, twice so that both
+  // counters are drained. Operations only try the ring and never wait inside
+  // a critical section, so grace periods are short. The cost in the common
+  // case is an increment and decrement of a counter that's mostly private to
+  // the thread.
+  //
+  // GrowableRing_ provides the epochs and the waiting, the segments are any
+  // ring with the interface of Ring<T> (Ring<T> or SlotRing<T>).
+
+  class GrowableRing_
+  {
+  public:
+    ////////////////////////////////////////////////////////////////////////////
+    // TYPE DEFINITIONS
+    ////////////////////////////////////////////////////////////////////////////
+
+    typedef std::chrono::steady_clock::time_point time_point;
+
+  protected:
+    ////////////////////////////////////////////////////////////////////////////
+    // PROTECTED MEMBERS
+    ////////////////////////////////////////////////////////////////////////////
+
+    static const int STRIPES = 16;
+
+    // Operations in progress, by epoch parity
+    struct alignas(64) stripe_
+    {
+      std::atomic<std::int64_t> active[2];
+    };
+
+    stripe_ stripes_[STRIPES];
+
+    alignas(64)
+    std::atomic<std::uint64_t> epoch_;       // flipped by grace periods
+    std::mutex                 grace_lock_;  // one grace period at a time
+
+    detail::Waiter waiter_; // how blocking operations wait
+
+  protected:
+    ////////////////////////////////////////////////////////////////////////////
+    // CONSTRUCTORS AND DESTRUCTORS
+    ////////////////////////////////////////////////////////////////////////////
+
+    GrowableRing_(WaitStrategy wait);
+
+    // Moves the wait strategy, assumes no concurrent operations
+    GrowableRing_(GrowableRing_&& ring);
+    GrowableRing_& operator= (GrowableRing_&& ring);
+
+    // No copying
+    GrowableRing_(const GrowableRing_&)             = delete;
+    GrowableRing_& operator= (const GrowableRing_&) = delete;
+
+  protected:
+    ////////////////////////////////////////////////////////////////////////////
+    // PROTECTED FUNCTIONS
+    ////////////////////////////////////////////////////////////////////////////
+
+    // Begins and ends a critical section, segments seen inside it stay valid
+    // until it ends. exit_ takes what enter_ returned
+    std::size_t enter_();
+    void        exit_(std::size_t token);
+
+    // Waits until every critical section that began before the call has
+    // ended. Must not be called inside a critical section
+    void synchronize_();
+
+  }; // class GrowableRing_
+
+  //////////////////////////////////////////////////////////////////////////////
+  // Queue of T in segments of type L, which it owns. Segments should be
+  // multi-producer and multi-consumer unless the queue is only used by one
+  // thread on that side.
+
+  template <class T, class L = Ring<T>>
+  class GrowableRing : protected GrowableRing_
+  {
+  public:
+    ////////////////////////////////////////////////////////////////////////////
+    // TYPE DEFINITIONS
+    ////////////////////////////////////////////////////////////////////////////
+
+    typedef GrowableRing_::time_point time_point;
+    typedef L                         segment_type;
+
+  private:
+
+    // Segments are allocated aligned for the ring, 'memory' is the allocation
+    struct segment_
+    {
+      L                      ring;
+      std::atomic<segment_*> next;   // segment written after this one
+      std::atomic<bool>      sealed; // no write can still add to the ring
+      char*                  memory;
+
+      segment_(std::size_t size, const RingOptions& options, char* memory);
+    };
+
+  private:
+    ////////////////////////////////////////////////////////////////////////////
+    // PRIVATE MEMBERS
+    ////////////////////////////////////////////////////////////////////////////
+
+    RingOptions options_;   // options of every segment
+    std::size_t max_;       // most elements held by all segments, 0 if any
+
+    alignas(64)
+    std::atomic<segment_*> head_; // segment being read
+    std::atomic<segment_*> tail_; // segment being written
+
+    alignas(64)
+    std::atomic<std::size_t> capacity_;  // elements held by all segments
+    std::mutex               grow_lock_; // one segment linked at a time
+
+  public:
+    ////////////////////////////////////////////////////////////////////////////
+    // CONSTRUCTORS AND DESTRUCTORS
+    ////////////////////////////////////////////////////////////////////////////
+
+    // Constructs a queue with one segment of 'size' elements, which grows up
+    // to 'max' elements in total (or without limit if 'max' is 0)
+    GrowableRing(std::size_t size, std::size_t max = 0);
+    GrowableRing(std::size_t size, std::size_t max, const RingOptions& options);
+
+    // Moves the segments between queues, assumes no concurrent operations
+    GrowableRing(GrowableRing&& ring);
+
+    // Moves the segments between queues, assumes no concurrent operations on
+    // either queue. Frees the segments
+    GrowableRing& operator= (GrowableRing&& ring);
+
+    // No copying
+    GrowableRing(const GrowableRing&)             = delete;
+    GrowableRing& operator= (const GrowableRing&) = delete;
+
+    // Frees the segments, destructs stored data
+    ~GrowableRing();
+
+  public:
+    ////////////////////////////////////////////////////////////////////////////
+    // QUERY FUNCTIONS
+    ////////////////////////////////////////////////////////////////////////////
+    // Functions only report on the state of the ring
+
+    // Returns the sum of the segments' sizes, each read at a different time
+    std::size_t size() const;
+
+    // Returns the number of elements the segments hold, including segments
+    // still being drained
+    std::size_t capacity() const;
+
+    // Most elements all segments may hold, 0 if there is no limit
+    std::size_t max_capacity() const;
+
+  public:
+    ////////////////////////////////////////////////////////////////////////////
+    // ACCESSORS AND MODIFIERS
+    ////////////////////////////////////////////////////////////////////////////
+    // All operations assume object has not been moved. Writes to a full queue
+    // grow it if its maximum capacity allows. Blocking operations run until
+    // operation is completed. Non-blocking operations fail if there is no
+    // element, or no space and no room to grow
+
+    void read(T& data) noexcept;
+    void write(const T& data) noexcept(std::is_nothrow_copy_constructible<T>::value);
+    void write(T&& data) noexcept;
+    bool try_read(T& data) noexcept;
+    bool try_write(const T& data) noexcept(std::is_nothrow_copy_constructible<T>::value);
+    bool try_write(T&& data) noexcept;
+
+    template <class Rep, class Period>
+    bool read_for(T& data, const std::chrono::duration<Rep, Period>& timeout) noexcept;
+    bool read_until(T& data, time_point deadline) noexcept;
+
+    template <class Rep, class Period>
+    bool write_for(const T& data, const std::chrono::duration<Rep, Period>& timeout) noexcept(std::is_nothrow_copy_constructible<T>::value);
+    template <class Rep, class Period>
+    bool write_for(T&& data, const std::chrono::duration<Rep, Period>& timeout) noexcept;
+    bool write_until(const T& data, time_point deadline) noexcept(std::is_nothrow_copy_constructible<T>::value);
+    bool write_until(T&& data, time_point deadline) noexcept;
+
+    // Links a segment of 'size' elements that later writes go to, behind the
+    // segments holding elements now. It can be smaller than the current one
+    // to shrink the queue once they're drained. Returns false if it would
+    // exceed the maximum capacity. Blocks for a grace period
+    bool resize(std::size_t size);
+
+  private:
+    ////////////////////////////////////////////////////////////////////////////
+    // PRIVATE HELPER FUNCTIONS
+    ////////////////////////////////////////////////////////////////////////////
+
+    static segment_* create_(std::size_t size, const RingOptions& options);
+    static void      destroy_(segment_* segment);
+
+    // Links a segment after 'tail' if it's still the last one (or after the
+    // last one if 'tail' is nullptr) and seals 'tail' after a grace period.
+    // The size defaults to twice that of 'tail', but no less than it if the
+    // maximum capacity is near. Returns true if a segment was linked or 'tail'
+    // already isn't the last, false if there's no room
+    bool grow_(segment_* tail, std::size_t size);
+
+    // Frees a segment after readers moved past it
+    void retire_(segment_* segment);
+
+    template <class U>
+    bool try_write_(U&& data);
+    bool try_read_(T& data);
+
+    void destruct_();
+
+  }; // class GrowableRing<T>
+
+  template <class T, class L>
+  GrowableRing<T, L>::segment_::segment_(std::size_t size, const RingOptions& options, char* memory)
+    : ring(size, options)
+    , memory(memory)
+  {
+    std::atomic_init(&next, static_cast<segment_*>(nullptr));
+    std::atomic_init(&sealed, false);
+  }
+
+  template <class T, class L>
+  GrowableRing<T, L>::GrowableRing(std::size_t size, std::size_t max)
+    : GrowableRing(size, max, RingOptions())
+  { }
+
+  template <class T, class L>
+  GrowableRing<T, L>::GrowableRing(std::size_t size, std::size_t max, const RingOptions& options)
+    : GrowableRing_(options.wait)
+    , options_(options)
+    , max_(max)
+  {
+    auto segment = create_(size, options);
+    std::atomic_init(&head_, segment);
+    std::atomic_init(&tail_, segment);
+    std::atomic_init(&capacity_, segment->ring.capacity());
+  }
+
+  template <class T, class L>
+  GrowableRing<T, L>::GrowableRing(GrowableRing&& ring)
+    : GrowableRing_(std::move(ring))
+    , options_(ring.options_)
+    , max_(ring.max_)
+  {
+    std::atomic_init(&head_, ring.head_.load());
+    std::atomic_init(&tail_, ring.tail_.load());
+    std::atomic_init(&capacity_, ring.capacity_.load());
+
+    // The moved-from queue keeps an empty segment so it stays usable
+
+    auto segment = create_(0, ring.options_);
+    ring.head_ = segment;
+    ring.tail_ = segment;
+    ring.capacity_ = 0;
+  }
+
+  template <class T, class L>
+  GrowableRing<T, L>& GrowableRing<T, L>::operator= (GrowableRing&& ring)
+  {
+    destruct_();
+
+    GrowableRing_::operator= (std::move(ring));
+    options_ = ring.options_;
+    max_ = ring.max_;
+    head_ = ring.head_.load();
+    tail_ = ring.tail_.load();
+    capacity_ = ring.capacity_.load();
+
+    auto segment = create_(0, ring.options_);
+    ring.head_ = segment;
+    ring.tail_ = segment;
+    ring.capacity_ = 0;
+
+    return *this;
+  }
+
+  template <class T, class L>
+  GrowableRing<T, L>::~GrowableRing()
+  {
+    destruct_();
+  }
+
+  template <class T, class L>
+  void GrowableRing<T, L>::destruct_()
+  {
+    auto segment = head_.load();
+    while (segment != nullptr)
+    {
+      auto next = segment->next.load();
+      destroy_(segment);
+      segment = next;
+    }
+  }
+
+  template <class T, class L>
+  typename GrowableRing<T, L>::segment_* GrowableRing<T, L>::create_(std::size_t size, const RingOptions& options)
+  {
+    auto memory = new char[sizeof(segment_) + alignof(segment_) - 1];
+    auto address = reinterpret_cast<std::uintptr_t>(memory);
+    auto segment = memory + (alignof(segment_) - address % alignof(segment_)) % alignof(segment_);
+
+    return new(segment) segment_(size, options, memory);
+  }
+
+  template <class T, class L>
+  void GrowableRing<T, L>::destroy_(segment_* segment)
+  {
+    auto memory = segment->memory;
+    segment->~segment_();
+    delete[] memory;
+  }
+
+  template <class T, class L>
+  std::size_t GrowableRing<T, L>::size() const
+  {
+    auto self = const_cast<GrowableRing*>(this);
+    auto token = self->enter_();
+
+    std::size_t size = 0;
+    for (auto segment = head_.load(); segment != nullptr; segment = segment->next.load())
+      size += segment->ring.size();
+
+    self->exit_(token);
+    return size;
+  }
+
+  template <class T, class L>
+  std::size_t GrowableRing<T, L>::capacity() const
+  {
+    return capacity_.load(std::memory_order_relaxed);
+  }
+
+  template <class T, class L>
+  std::size_t GrowableRing<T, L>::max_capacity() const
+  {
+    return max_;
+  }
+
+  template <class T, class L>
+  bool GrowableRing<T, L>::grow_(segment_* tail, std::size_t size)
+  {
+    segment_* segment;
+    {
+      std::lock_guard<std::mutex> lock(grow_lock_);
+      auto last = tail_.load();
+      if (tail != nullptr && tail != last)
+        return true;                                        // grown by another
+
+      // Only the last segment is ever dereferenced outside a critical
+      // section, it can't be freed before another is linked after it
+
+      // Growing into a segment smaller than the last would only add more
+      // segments to seal and free, writers wait for readers instead
+
+      tail = last;
+      auto least = size != 0 ? size : tail->ring.capacity() > 0 ? tail->ring.capacity() : 1;
+      if (size == 0)
+        size = 2 * least;
+      if (max_ != 0)
+      {
+        auto capacity = capacity_.load();
+        if (capacity + least > max_)
+          return false;                                     // no room to grow
+        if (size > max_ - capacity)
+          size = max_ - capacity;
+      }
+
+      segment = create_(size, options_);
+      capacity_.fetch_add(segment->ring.capacity());
+      tail->next.store(segment);
+      tail_.store(segment);                                 // redirect writes
+    }
+
+    // Writers that saw the old segment last may still be adding to it until
+    // their critical sections end, after that readers can drain it for good
+
+    synchronize_();
+    tail->sealed.store(true);
+    waiter_.notify();
+    return true;
+  }
+
+  template <class T, class L>
+  void GrowableRing<T, L>::retire_(segment_* segment)
+  {
+    synchronize_();
+    capacity_.fetch_sub(segment->ring.capacity());
+    destroy_(segment);
+  }
+
+  template <class T, class L>
+  template <class U>
+  bool GrowableRing<T, L>::try_write_(U&& data)
+  {
+    while (true)
+    {
+      auto token = enter_();
+      auto tail = tail_.load();
+      auto written = tail->ring.try_write(std::forward<U>(data));
+      auto full = !written && max_ != 0 && capacity_.load(std::memory_order_relaxed) + tail->ring.capacity() > max_;
+      exit_(token);
+
+      if (written)
+      {
+        waiter_.notify();
+        return true;
+      }
+
+      if (full || !grow_(tail, 0))                          // no room to grow
+        return false;
+    }
+  }
+
+  template <class T, class L>
+  bool GrowableRing<T, L>::try_read_(T& data)
+  {
+    while (true)
+    {
+      auto token = enter_();
+      auto head = head_.load();
+      auto read = head->ring.try_read(data);
+      segment_* retired = nullptr;
+
+      // Once a segment is sealed every write to it has completed, so if it
+      // is still empty after that readers move on to the next
+
+      while (!read)
+      {
+        auto next = head->next.load();
+        if (next == nullptr || !head->sealed.load())
+          break;
+
+        if ((read = head->ring.try_read(data)))
+          break;
+
+        if (head_.compare_exchange_strong(head, next))
+        {
+          retired = head;
+          break;
+        }
+
+        read = head->ring.try_read(data);                   // moved by another
+      }
+      exit_(token);
+
+      if (retired == nullptr)
+      {
+        if (read)
+          waiter_.notify();
+        return read;
+      }
+
+      retire_(retired);
+    }
+  }
+
+  template <class T, class L>
+  void GrowableRing<T, L>::read(T& data) noexcept
+  {
+    waiter_.wait_until([&]{ return try_read_(data); }, nullptr);
+  }
+
+  template <class T, class L>
+  void GrowableRing<T, L>::write(const T& data) noexcept(std::is_nothrow_copy_constructible<T>::value)
+  {
+    waiter_.wait_until([&]{ return try_write_(data); }, nullptr);
+  }
+
+  template <class T, class L>
+  void GrowableRing<T, L>::write(T&& data) noexcept
+  {
+    waiter_.wait_until([&]{ return try_write_(std::move(data)); }, nullptr);
+  }
+
+  template <class T, class L>
+  bool GrowableRing<T, L>::try_read(T& data) noexcept
+  {
+    return try_read_(data);
+  }
+
+  template <class T, class L>
+  bool GrowableRing<T, L>::try_write(const T& data) noexcept(std::is_nothrow_copy_constructible<T>::value)
+  {
+    return try_write_(data);
+  }
+
+  template <class T, class L>
+  bool GrowableRing<T, L>::try_write(T&& data) noexcept
+  {
+    return try_write_(std::move(data));
+  }
+
+  template <class T, class L>
+  template <class Rep, class Period>
+  bool GrowableRing<T, L>::read_for(T& data, const std::chrono::duration<Rep, Period>& timeout) noexcept
+  {
+    return read_until(data, std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(timeout));
+  }
+
+  template <class T, class L>
+  bool GrowableRing<T, L>::read_until(T& data, time_point deadline) noexcept
+  {
+    return waiter_.wait_until([&]{ return try_read_(data); }, &deadline);
+  }
+
+  template <class T, class L>
+  template <class Rep, class Period>
+  bool GrowableRing<T, L>::write_for(const T& data, const std::chrono::duration<Rep, Period>& timeout) noexcept(std::is_nothrow_copy_constructible<T>::value)
+  {
+    return write_until(data, std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(timeout));
+  }
+
+  template <class T, class L>
+  template <class Rep, class Period>
+  bool GrowableRing<T, L>::write_for(T&& data, const std::chrono::duration<Rep, Period>& timeout) noexcept
+  {
+    return write_until(std::move(data), std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(timeout));
+  }
+
+  template <class T, class L>
+  bool GrowableRing<T, L>::write_until(const T& data, time_point deadline) noexcept(std::is_nothrow_copy_constructible<T>::value)
+  {
+    return waiter_.wait_until([&]{ return try_write_(data); }, &deadline);
+  }
+
+  template <class T, class L>
+  bool GrowableRing<T, L>::write_until(T&& data, time_point deadline) noexcept
+  {
+    return waiter_.wait_until([&]{ return try_write_(std::move(data)); }, &deadline);
+  }
+
+  template <class T, class L>
+  bool GrowableRing<T, L>::resize(std::size_t size)
+  {
+    return grow_(nullptr, size != 0 ? size : 1);
+  }
+
+} // namespace wilt
+
+#endif // !WILT_GROWABLE_RING_H
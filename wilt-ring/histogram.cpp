@@ -0,0 +1,195 @@
+////////////////////////////////////////////////////////////////////////////////
+// FILE: histogram.cpp
+// DATE: 2026-10-14
+// AUTH: Trevor Wilson
+// DESC: Implements a log-bucketed histogram for recording latencies
+
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2016 Trevor Wilson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy 
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell 
+// copies of the Software, and to permit persons to whom the Software is 
+// furnished to do so, subject to the following conditions :
+// 
+//   The above copyright notice and this permission notice shall be included in
+//   all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE 
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "histogram.h"
+using namespace wilt;
+
+#include <cmath>
+// - std::ceil
+
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+// - _BitScanReverse64
+#endif
+
+namespace
+{
+  // Returns the index of the highest set bit, value must not be 0
+  inline int highest_bit(std::uint64_t value)
+  {
+#if defined(__GNUC__) || defined(__clang__)
+    return 63 - __builtin_clzll(value);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    unsigned long index;
+    _BitScanReverse64(&index, value);
+    return static_cast<int>(index);
+#else
+    int index = 0;
+    while (value >>= 1)
+      ++index;
+    return index;
+#endif
+  }
+
+} // namespace
+
+const int         LatencyHistogram::SUB_BITS;
+const std::size_t LatencyHistogram::BUCKETS;
+
+LatencyHistogram::LatencyHistogram()
+{
+  for (auto& count : counts_)
+    std::atomic_init(&count, static_cast<std::uint64_t>(0));
+
+  std::atomic_init(&total_, static_cast<std::uint64_t>(0));
+  std::atomic_init(&max_, static_cast<std::uint64_t>(0));
+}
+
+std::uint64_t LatencyHistogram::count() const
+{
+  std::uint64_t count = 0;
+  for (auto& bucket : counts_)
+    count += bucket.load(std::memory_order_relaxed);
+
+  return count;
+}
+
+std::uint64_t LatencyHistogram::max() const
+{
+  return max_.load(std::memory_order_relaxed);
+}
+
+double LatencyHistogram::mean() const
+{
+  auto count = this->count();
+  if (count == 0)
+    return 0.0;
+
+  return static_cast<double>(total_.load(std::memory_order_relaxed)) / static_cast<double>(count);
+}
+
+std::uint64_t LatencyHistogram::percentile(double percent) const
+{
+  auto count = this->count();
+  if (count == 0)
+    return 0;
+
+  // The rank of the value is rounded up, so the 100th percentile is the
+  // largest value and any percentile of a single value is that value
+
+  auto rank = static_cast<std::uint64_t>(std::ceil(percent / 100.0 * static_cast<double>(count)));
+  if (rank < 1)
+    rank = 1;
+  if (rank > count)
+    rank = count;
+
+  std::uint64_t seen = 0;
+  for (std::size_t i = 0; i < BUCKETS; ++i)
+  {
+    seen += counts_[i].load(std::memory_order_relaxed);
+    if (seen >= rank)
+    {
+      auto upper = bucket_upper(i);
+      auto max = this->max();
+      return upper < max ? upper : max;
+    }
+  }
+
+  return max();
+}
+
+std::uint64_t LatencyHistogram::bucket_count(std::size_t i) const
+{
+  return counts_[i].load(std::memory_order_relaxed);
+}
+
+std::uint64_t LatencyHistogram::bucket_lower(std::size_t i)
+{
+  // The first 2^SUB_BITS buckets hold one value each, after that every group
+  // of 2^SUB_BITS buckets covers the next power of two
+
+  const std::size_t SUB_COUNT = std::size_t(1) << SUB_BITS;
+  if (i < SUB_COUNT)
+    return i;
+
+  auto shift = static_cast<int>(i >> SUB_BITS) - 1;
+  auto mantissa = static_cast<std::uint64_t>(SUB_COUNT + (i & (SUB_COUNT - 1)));
+  return mantissa << shift;
+}
+
+std::uint64_t LatencyHistogram::bucket_upper(std::size_t i)
+{
+  const std::size_t SUB_COUNT = std::size_t(1) << SUB_BITS;
+  if (i < SUB_COUNT)
+    return i;
+
+  auto shift = static_cast<int>(i >> SUB_BITS) - 1;
+  return bucket_lower(i) + ((static_cast<std::uint64_t>(1) << shift) - 1);
+}
+
+std::size_t LatencyHistogram::bucket(std::uint64_t value)
+{
+  const std::uint64_t SUB_COUNT = static_cast<std::uint64_t>(1) << SUB_BITS;
+  if (value < SUB_COUNT)
+    return static_cast<std::size_t>(value);
+
+  auto shift = highest_bit(value) - SUB_BITS;
+  auto mantissa = value >> shift;
+  return static_cast<std::size_t>((static_cast<std::uint64_t>(shift + 1) << SUB_BITS) + (mantissa - SUB_COUNT));
+}
+
+void LatencyHistogram::record(std::uint64_t value) noexcept
+{
+  counts_[bucket(value)].fetch_add(1, std::memory_order_relaxed);
+  total_.fetch_add(value, std::memory_order_relaxed);
+
+  auto max = max_.load(std::memory_order_relaxed);
+  while (value > max && !max_.compare_exchange_weak(max, value, std::memory_order_relaxed))
+    ;
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& histogram) noexcept
+{
+  for (std::size_t i = 0; i < BUCKETS; ++i)
+    counts_[i].fetch_add(histogram.bucket_count(i), std::memory_order_relaxed);
+
+  total_.fetch_add(histogram.total_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+
+  auto value = histogram.max();
+  auto max = max_.load(std::memory_order_relaxed);
+  while (value > max && !max_.compare_exchange_weak(max, value, std::memory_order_relaxed))
+    ;
+}
+
+void LatencyHistogram::reset() noexcept
+{
+  for (auto& count : counts_)
+    count.store(0, std::memory_order_relaxed);
+
+  total_.store(0, std::memory_order_relaxed);
+  max_.store(0, std::memory_order_relaxed);
+}
@@ -0,0 +1,125 @@
+////////////////////////////////////////////////////////////////////////////////
+// FILE: histogram.h
+// DATE: 2026-10-14
+// AUTH: Trevor Wilson
+// DESC: Defines a log-bucketed histogram for recording latencies
+
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2016 Trevor Wilson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+//   The above copyright notice and this permission notice shall be included in
+//   all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef WILT_HISTOGRAM_H
+#define WILT_HISTOGRAM_H
+
+#include <atomic>
+// - std::atomic
+#include <cstddef>
+// - std::size_t
+#include <cstdint>
+// - std::uint64_t
+
+namespace wilt
+{
+  //////////////////////////////////////////////////////////////////////////////
+  // This structure counts values (typically latencies in nanoseconds) in
+  // buckets whose width grows with the value, like an HDR histogram. Each
+  // power of two is split into 32 buckets, so a reported value is within
+  // about 3% of the recorded ones while the whole 64-bit range fits in a
+  // fixed 2 thousand buckets.
+  //
+  // Values can be recorded from any number of threads concurrently. The
+  // query functions read the buckets individually, so they are only exact
+  // if nothing is being recorded.
+
+  class LatencyHistogram
+  {
+  public:
+    ////////////////////////////////////////////////////////////////////////////
+    // TYPE DEFINITIONS
+    ////////////////////////////////////////////////////////////////////////////
+
+    static const int         SUB_BITS = 5; // log2 of the buckets per power of two
+    static const std::size_t BUCKETS  = (64 - SUB_BITS + 1) << SUB_BITS;
+
+  private:
+    ////////////////////////////////////////////////////////////////////////////
+    // PRIVATE MEMBERS
+    ////////////////////////////////////////////////////////////////////////////
+
+    std::atomic<std::uint64_t> counts_[BUCKETS];
+    std::atomic<std::uint64_t> total_; // sum of the recorded values
+    std::atomic<std::uint64_t> max_;   // largest recorded value
+
+  public:
+    ////////////////////////////////////////////////////////////////////////////
+    // CONSTRUCTORS AND DESTRUCTORS
+    ////////////////////////////////////////////////////////////////////////////
+
+    // Constructs an empty histogram
+    LatencyHistogram();
+
+    // No copying
+    LatencyHistogram(const LatencyHistogram&)             = delete;
+    LatencyHistogram& operator= (const LatencyHistogram&) = delete;
+
+  public:
+    ////////////////////////////////////////////////////////////////////////////
+    // QUERY FUNCTIONS
+    ////////////////////////////////////////////////////////////////////////////
+
+    // Number of values recorded
+    std::uint64_t count() const;
+
+    // Largest and mean value recorded, 0 if there are none
+    std::uint64_t max() const;
+    double        mean() const;
+
+    // Returns the value that 'percent' percent of the recorded values are at
+    // or below, rounded up to the end of its bucket (but not beyond max())
+    std::uint64_t percentile(double percent) const;
+
+    // Buckets can be read individually for exporting the whole distribution,
+    // bucket 'i' counts the values from bucket_lower(i) to bucket_upper(i)
+    std::uint64_t bucket_count(std::size_t i) const;
+    static std::uint64_t bucket_lower(std::size_t i);
+    static std::uint64_t bucket_upper(std::size_t i);
+
+    // Returns the bucket a value is counted in
+    static std::size_t bucket(std::uint64_t value);
+
+  public:
+    ////////////////////////////////////////////////////////////////////////////
+    // ACCESSORS AND MODIFIERS
+    ////////////////////////////////////////////////////////////////////////////
+
+    void record(std::uint64_t value) noexcept;
+
+    // Adds the counts of another histogram
+    void merge(const LatencyHistogram& histogram) noexcept;
+
+    // Removes all recorded values
+    void reset() noexcept;
+
+  }; // class LatencyHistogram
+
+} // namespace wilt
+
+#endif // !WILT_HISTOGRAM_H
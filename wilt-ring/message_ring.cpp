@@ -0,0 +1,444 @@
+////////////////////////////////////////////////////////////////////////////////
+// FILE: message_ring.cpp
+// DATE: 2026-10-14
+// AUTH: Trevor Wilson
+// DESC: Implements a lock-free ring buffer of variable-length messages
+
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2016 Trevor Wilson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy 
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell 
+// copies of the Software, and to permit persons to whom the Software is 
+// furnished to do so, subject to the following conditions :
+// 
+//   The above copyright notice and this permission notice shall be included in
+//   all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE 
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "message_ring.h"
+using namespace wilt;
+
+#include <cstring>
+// - std::memcpy
+
+namespace
+{
+  // Records are aligned to their header
+  const std::size_t ALIGNMENT = 8;
+
+  // Longest message a header can describe
+  const std::size_t MAX_LENGTH = 0xFFFFFFFF;
+
+  std::size_t round_size(std::size_t size)
+  {
+    return (size + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+  }
+
+} // namespace
+
+MessageRing::MessageRing()
+  : Ring_()
+{ }
+
+MessageRing::MessageRing(std::size_t size)
+  : Ring_(round_size(size))
+{ }
+
+MessageRing::MessageRing(std::size_t size, const RingOptions& options)
+  : Ring_(round_size(size), options)
+{
+  drop_records_(sizeof(header_), &measure_);
+}
+
+MessageRing::MessageRing(MessageRing&& ring)
+  : Ring_(std::move(ring))
+{ }
+
+MessageRing& MessageRing::operator= (MessageRing&& ring)
+{
+  Ring_::operator= (std::move(ring));
+
+  return *this;
+}
+
+std::size_t MessageRing::size() const
+{
+  return Ring_::size();
+}
+
+std::size_t MessageRing::capacity() const
+{
+  return Ring_::capacity();
+}
+
+std::size_t MessageRing::max_size() const
+{
+  auto size = capacity();
+  if (size < sizeof(header_))
+    return 0;
+
+  size -= sizeof(header_);
+  return size < MAX_LENGTH ? size : MAX_LENGTH;
+}
+
+bool MessageRing::mirrored() const
+{
+  return Ring_::mirrored();
+}
+
+std::uint64_t MessageRing::dropped() const
+{
+  return Ring_::dropped();
+}
+
+MessageRing::event_handle MessageRing::read_event() const
+{
+  return Ring_::read_event();
+}
+
+MessageRing::event_handle MessageRing::write_event() const
+{
+  return Ring_::write_event();
+}
+
+MessageRing::WriteMessage::WriteMessage()
+  : ring_(nullptr)
+  , pos_(0)
+  , data_(nullptr)
+  , size_(0)
+  , total_(0)
+{ }
+
+MessageRing::WriteMessage::WriteMessage(MessageRing* ring, char* data, std::uint64_t pos, std::size_t size, std::size_t total)
+  : ring_(ring)
+  , pos_(pos)
+  , data_(data)
+  , size_(size)
+  , total_(total)
+{ }
+
+MessageRing::WriteMessage::WriteMessage(WriteMessage&& message)
+  : ring_(message.ring_)
+  , pos_(message.pos_)
+  , data_(message.data_)
+  , size_(message.size_)
+  , total_(message.total_)
+{
+  message.ring_ = nullptr;
+}
+
+MessageRing::WriteMessage& MessageRing::WriteMessage::operator= (WriteMessage&& message)
+{
+  commit();
+
+  ring_  = message.ring_;
+  pos_   = message.pos_;
+  data_  = message.data_;
+  size_  = message.size_;
+  total_ = message.total_;
+
+  message.ring_ = nullptr;
+
+  return *this;
+}
+
+MessageRing::WriteMessage::~WriteMessage()
+{
+  commit();
+}
+
+void MessageRing::WriteMessage::commit() noexcept
+{
+  if (ring_ == nullptr)
+    return;
+
+  ring_->release_write_block_(pos_, total_);
+  ring_ = nullptr;
+}
+
+MessageRing::ReadMessage::ReadMessage()
+  : ring_(nullptr)
+  , pos_(0)
+  , data_(nullptr)
+  , size_(0)
+  , total_(0)
+{ }
+
+MessageRing::ReadMessage::ReadMessage(MessageRing* ring, const char* data, std::uint64_t pos, std::size_t size, std::size_t total)
+  : ring_(ring)
+  , pos_(pos)
+  , data_(data)
+  , size_(size)
+  , total_(total)
+{ }
+
+MessageRing::ReadMessage::ReadMessage(ReadMessage&& message)
+  : ring_(message.ring_)
+  , pos_(message.pos_)
+  , data_(message.data_)
+  , size_(message.size_)
+  , total_(message.total_)
+{
+  message.ring_ = nullptr;
+}
+
+MessageRing::ReadMessage& MessageRing::ReadMessage::operator= (ReadMessage&& message)
+{
+  commit();
+
+  ring_  = message.ring_;
+  pos_   = message.pos_;
+  data_  = message.data_;
+  size_  = message.size_;
+  total_ = message.total_;
+
+  message.ring_ = nullptr;
+
+  return *this;
+}
+
+MessageRing::ReadMessage::~ReadMessage()
+{
+  commit();
+}
+
+void MessageRing::ReadMessage::commit() noexcept
+{
+  if (ring_ == nullptr)
+    return;
+
+  ring_->release_read_block_(pos_, total_);
+  ring_ = nullptr;
+}
+
+bool MessageRing::write(const void* data, std::size_t length) noexcept
+{
+  if (length > max_size())
+    return false;
+
+  std::uint64_t pos;
+  std::size_t total;
+  auto block = acquire_message_(length, pos, total, true);
+
+  copy_write_block_(block, static_cast<const char*>(data), length);
+  release_write_block_(pos, total);
+
+  return true;
+}
+
+bool MessageRing::try_write(const void* data, std::size_t length) noexcept
+{
+  if (length > max_size())
+    return false;
+
+  std::uint64_t pos;
+  std::size_t total;
+  auto block = acquire_message_(length, pos, total, false);
+  if (block == nullptr)
+    return false;
+
+  copy_write_block_(block, static_cast<const char*>(data), length);
+  release_write_block_(pos, total);
+
+  return true;
+}
+
+bool MessageRing::write(const WriteSegment* segments, std::size_t count) noexcept
+{
+  auto length = gather_length_(segments, count);
+  if (length > max_size())
+    return false;
+
+  std::uint64_t pos;
+  std::size_t total;
+  auto block = acquire_message_(length, pos, total, true);
+
+  gather_write_block_(block, segments, count);
+  release_write_block_(pos, total);
+
+  return true;
+}
+
+bool MessageRing::try_write(const WriteSegment* segments, std::size_t count) noexcept
+{
+  auto length = gather_length_(segments, count);
+  if (length > max_size())
+    return false;
+
+  std::uint64_t pos;
+  std::size_t total;
+  auto block = acquire_message_(length, pos, total, false);
+  if (block == nullptr)
+    return false;
+
+  gather_write_block_(block, segments, count);
+  release_write_block_(pos, total);
+
+  return true;
+}
+
+MessageRing::WriteMessage MessageRing::reserve_message(std::size_t length) noexcept
+{
+  if (length > max_size())
+    return WriteMessage();
+
+  std::uint64_t pos;
+  std::size_t total;
+  auto block = acquire_message_(length, pos, total, true);
+
+  return WriteMessage(this, block, pos, length, total);
+}
+
+MessageRing::WriteMessage MessageRing::try_reserve_message(std::size_t length) noexcept
+{
+  if (length > max_size())
+    return WriteMessage();
+
+  std::uint64_t pos;
+  std::size_t total;
+  auto block = acquire_message_(length, pos, total, false);
+  if (block == nullptr)
+    return WriteMessage();
+
+  return WriteMessage(this, block, pos, length, total);
+}
+
+std::size_t MessageRing::read(void* data, std::size_t length) noexcept
+{
+  std::uint64_t pos;
+  std::size_t size, total;
+  auto block = acquire_next_(size, pos, total, true);
+
+  std::memcpy(data, block, size < length ? size : length);
+  release_read_block_(pos, total);
+
+  return size;
+}
+
+std::size_t MessageRing::try_read(void* data, std::size_t length) noexcept
+{
+  std::uint64_t pos;
+  std::size_t size, total;
+  auto block = acquire_next_(size, pos, total, false);
+  if (block == nullptr)
+    return 0;
+
+  std::memcpy(data, block, size < length ? size : length);
+  release_read_block_(pos, total);
+
+  return size;
+}
+
+MessageRing::ReadMessage MessageRing::read_message() noexcept
+{
+  std::uint64_t pos;
+  std::size_t size, total;
+  auto block = acquire_next_(size, pos, total, true);
+
+  return ReadMessage(this, block, pos, size, total);
+}
+
+MessageRing::ReadMessage MessageRing::try_read_message() noexcept
+{
+  std::uint64_t pos;
+  std::size_t size, total;
+  auto block = acquire_next_(size, pos, total, false);
+  if (block == nullptr)
+    return ReadMessage();
+
+  return ReadMessage(this, block, pos, size, total);
+}
+
+void MessageRing::clear_read_event()
+{
+  Ring_::clear_read_event();
+}
+
+void MessageRing::clear_write_event()
+{
+  Ring_::clear_write_event();
+}
+
+std::size_t MessageRing::record_size_(std::size_t length)
+{
+  return sizeof(header_) + round_size(length);
+}
+
+std::size_t MessageRing::measure_(const char* header)
+{
+  header_ head;
+  std::memcpy(&head, header, sizeof(head));
+
+  return record_size_(head.length);
+}
+
+std::size_t MessageRing::gather_length_(const WriteSegment* segments, std::size_t count)
+{
+  std::size_t length = 0;
+  for (std::size_t i = 0; i < count; ++i)
+    length += segments[i].length;
+
+  return length;
+}
+
+char* MessageRing::acquire_message_(std::size_t length, std::uint64_t& pos, std::size_t& total, bool blocking)
+{
+  auto record = record_size_(length);
+  while (true)                                              // loop while padding only
+  {
+    std::size_t padding;
+    auto block = blocking                                   // reserve record
+      ? acquire_padded_write_block_(record, padding, total, pos)
+      : try_acquire_padded_write_block_(record, padding, total, pos);
+    if (block == nullptr)
+      return nullptr;                                       // return no space
+
+    if (padding != 0)                                       // write skip record
+    {
+      header_ head = { static_cast<std::uint32_t>(padding - sizeof(header_)), PADDING };
+      std::memcpy(block, &head, sizeof(head));
+    }
+
+    if (total > padding)                                    // write header
+    {
+      header_ head = { static_cast<std::uint32_t>(length), 0 };
+      block = block_(pos + padding);
+      std::memcpy(block, &head, sizeof(head));
+      return block + sizeof(header_);                       // reserved
+    }
+
+    release_write_block_(pos, total);                       // commit padding
+  }
+}
+
+const char* MessageRing::acquire_next_(std::size_t& length, std::uint64_t& pos, std::size_t& total, bool blocking)
+{
+  while (true)                                              // loop while padding
+  {
+    auto block = blocking                                   // reserve record
+      ? acquire_measured_read_block_(sizeof(header_), &measure_, total, pos)
+      : try_acquire_measured_read_block_(sizeof(header_), &measure_, total, pos);
+    if (block == nullptr)
+      return nullptr;                                       // return no message
+
+    header_ head;
+    std::memcpy(&head, block, sizeof(head));                // read header
+    if ((head.flags & PADDING) == 0)
+    {
+      length = head.length;
+      return block + sizeof(header_);                       // reserved
+    }
+
+    release_read_block_(pos, total);                        // skip padding
+  }
+}
@@ -0,0 +1,266 @@
+////////////////////////////////////////////////////////////////////////////////
+// FILE: message_ring.h
+// DATE: 2026-10-14
+// AUTH: Trevor Wilson
+// DESC: Defines a lock-free ring buffer of variable-length messages
+
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2016 Trevor Wilson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+//   The above copyright notice and this permission notice shall be included in
+//   all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef WILT_MESSAGE_RING_H
+#define WILT_MESSAGE_RING_H
+
+#include <cstddef>
+// - std::size_t
+#include <cstdint>
+// - std::uint32_t
+// - std::uint64_t
+
+#include "ring.h"
+// - wilt::Ring_
+// - wilt::RingOptions
+// - wilt::WriteSegment
+
+namespace wilt
+{
+  //////////////////////////////////////////////////////////////////////////////
+  // This structure stores messages of any length in a Ring_. Each message is
+  // written as a single record of an 8 byte header (a 32-bit length and 32
+  // bits of flags, so messages are under 4 GiB) and the message padded to a
+  // multiple of 8 bytes, so messages from different producers never
+  // interleave and take one reservation each.
+  //
+  // Records never wrap around the end of the buffer. When a record wouldn't
+  // fit before the end, the writer reserves the remainder along with it and
+  // fills it with a padding record that readers skip. This means messages are
+  // always contiguous and can be read or written in place, but a message can
+  // use up to twice its size of the ring at the wrap point. Mirrored rings
+  // never need padding.
+  //
+  // Messages may be at most max_size() bytes; writes of anything larger fail
+  // right away, blocking or not. With RingOptions::overwrite, writes drop
+  // the oldest whole messages to make room.
+
+  class MessageRing : protected Ring_
+  {
+  public:
+    ////////////////////////////////////////////////////////////////////////////
+    // TYPE DEFINITIONS
+    ////////////////////////////////////////////////////////////////////////////
+
+    typedef Ring_::time_point   time_point;
+    typedef Ring_::event_handle event_handle;
+
+  private:
+
+    struct header_
+    {
+      std::uint32_t length; // length of the message, or of the padding
+      std::uint32_t flags;  // PADDING if readers should skip the record
+    };
+
+    static const std::uint32_t PADDING = 1;
+
+  public:
+    ////////////////////////////////////////////////////////////////////////////
+    // CONSTRUCTORS AND DESTRUCTORS
+    ////////////////////////////////////////////////////////////////////////////
+
+    // Constructs a ring without a buffer (capacity() == 0)
+    MessageRing();
+
+    // Constructs a ring with a buffer with a size, which is rounded up to a
+    // multiple of 8 bytes
+    MessageRing(std::size_t size);
+    MessageRing(std::size_t size, const RingOptions& options);
+
+    // Moves the buffer between rings, assumes no concurrent operations
+    MessageRing(MessageRing&& ring);
+
+    // Moves the buffer between rings, assumes no concurrent operations on
+    // either ring. Deallocates the buffer
+    MessageRing& operator= (MessageRing&& ring);
+
+    // No copying
+    MessageRing(const MessageRing&)             = delete;
+    MessageRing& operator= (const MessageRing&) = delete;
+
+  public:
+    ////////////////////////////////////////////////////////////////////////////
+    // QUERY FUNCTIONS
+    ////////////////////////////////////////////////////////////////////////////
+    // Functions only report on the state of the ring
+
+    // Returns the current amount of unclaimed data in bytes, including record
+    // headers and padding
+    std::size_t size() const;
+
+    // Maximum amount of data that can be held, including record headers
+    std::size_t capacity() const;
+
+    // Largest message that can be written
+    std::size_t max_size() const;
+
+    // Returns whether the buffer is mirrored, meaning no padding is needed
+    bool mirrored() const;
+
+    // Returns the amount of data overwriting writes have dropped so far in
+    // bytes, including record headers and padding. Readers can compare it
+    // between reads to tell whether they missed messages
+    std::uint64_t dropped() const;
+
+    // Readiness events, with RingOptions::events (see Ring_::read_event)
+    event_handle read_event() const;
+    event_handle write_event() const;
+
+  public:
+    ////////////////////////////////////////////////////////////////////////////
+    // MESSAGE VIEWS
+    ////////////////////////////////////////////////////////////////////////////
+    // Views hold the reservation of a single message, which is contiguous in
+    // the buffer. Like Ring_'s blocks, they are committed by commit() or when
+    // they are destroyed, and later operations wait on them.
+
+    class WriteMessage
+    {
+    public:
+      // Constructs an empty view (holds no reservation)
+      WriteMessage();
+
+      // Moves the reservation between views
+      WriteMessage(WriteMessage&& message);
+      WriteMessage& operator= (WriteMessage&& message);
+
+      // No copying
+      WriteMessage(const WriteMessage&)             = delete;
+      WriteMessage& operator= (const WriteMessage&) = delete;
+
+      // Commits the message if it hasn't already been
+      ~WriteMessage();
+
+      explicit operator bool() const { return ring_ != nullptr; }
+
+      char*       data() const { return data_; }
+      std::size_t size() const { return size_; }
+
+      // Makes the message available to readers, the view is empty afterwards
+      void commit() noexcept;
+
+    private:
+      friend class MessageRing;
+      WriteMessage(MessageRing* ring, char* data, std::uint64_t pos, std::size_t size, std::size_t total);
+
+      MessageRing*  ring_;
+      std::uint64_t pos_;
+      char*         data_;
+      std::size_t   size_;
+      std::size_t   total_; // size of the record including padding
+
+    }; // class WriteMessage
+
+    class ReadMessage
+    {
+    public:
+      // Constructs an empty view (holds no reservation)
+      ReadMessage();
+
+      // Moves the reservation between views
+      ReadMessage(ReadMessage&& message);
+      ReadMessage& operator= (ReadMessage&& message);
+
+      // No copying
+      ReadMessage(const ReadMessage&)             = delete;
+      ReadMessage& operator= (const ReadMessage&) = delete;
+
+      // Commits the message if it hasn't already been
+      ~ReadMessage();
+
+      explicit operator bool() const { return ring_ != nullptr; }
+
+      const char* data() const { return data_; }
+      std::size_t size() const { return size_; }
+
+      // Returns the space to writers, the view is empty afterwards
+      void commit() noexcept;
+
+    private:
+      friend class MessageRing;
+      ReadMessage(MessageRing* ring, const char* data, std::uint64_t pos, std::size_t size, std::size_t total);
+
+      MessageRing*  ring_;
+      std::uint64_t pos_;
+      const char*   data_;
+      std::size_t   size_;
+      std::size_t   total_; // size of the record
+
+    }; // class ReadMessage
+
+  public:
+    ////////////////////////////////////////////////////////////////////////////
+    // ACCESSORS AND MODIFIERS
+    ////////////////////////////////////////////////////////////////////////////
+    // All operations assume object has not been moved. Blocking operations run
+    // until operation is completed. Non-blocking operations fail if there is
+    // not enough space or no message. Writes of messages larger than
+    // max_size() always fail, so blocking writes return whether the message
+    // fit and reserve_message returns an empty handle
+
+    bool write(const void* data, std::size_t length) noexcept;
+    bool try_write(const void* data, std::size_t length) noexcept;
+
+    // Writes the segments as a single message of their total length
+    bool write(const WriteSegment* segments, std::size_t count) noexcept;
+    bool try_write(const WriteSegment* segments, std::size_t count) noexcept;
+
+    WriteMessage reserve_message(std::size_t length) noexcept;
+    WriteMessage try_reserve_message(std::size_t length) noexcept;
+
+    // Reads the next message into 'data' and returns its size. Only the first
+    // 'length' bytes are copied, the rest of a larger message is discarded.
+    // The non-blocking read returns 0 if there is no message (which can't be
+    // told apart from an empty message, use try_read_message() for that)
+    std::size_t read(void* data, std::size_t length) noexcept;
+    std::size_t try_read(void* data, std::size_t length) noexcept;
+
+    ReadMessage read_message() noexcept;
+    ReadMessage try_read_message() noexcept;
+
+    // Makes an event not ready until the next commit (see Ring_)
+    void clear_read_event();
+    void clear_write_event();
+
+  private:
+    ////////////////////////////////////////////////////////////////////////////
+    // PRIVATE HELPER FUNCTIONS
+    ////////////////////////////////////////////////////////////////////////////
+
+    static std::size_t record_size_(std::size_t length);
+    static std::size_t measure_(const char* header);
+    static std::size_t gather_length_(const WriteSegment* segments, std::size_t count);
+
+    char* acquire_message_(std::size_t length, std::uint64_t& pos, std::size_t& total, bool blocking);
+    const char* acquire_next_(std::size_t& length, std::uint64_t& pos, std::size_t& total, bool blocking);
+
+  }; // class MessageRing
+
+} // namespace wilt
+
+#endif // !WILT_MESSAGE_RING_H
@@ -29,185 +29,2404 @@
 #include "ring.h"
 using namespace wilt;
 
+#include <cerrno>
+// - errno
+// - EINTR
+// - EINVAL
+// - ENOSYS
+#include <climits>
+// - CHAR_BIT
+#include <cstdio>
+// - std::snprintf
 #include <cstring>
 // - std::memcpy
 
+#if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+#include <intrin.h>
+// - __cpuid
+// - __cpuidex
+// - _mm_pause
+// - _xgetbv
+#endif
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <immintrin.h>
+// - _mm_sfence
+// - _mm_stream_si128
+// - _mm256_stream_si256
+#endif
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+// - CreateEventA
+// - CreateFileMappingW
+// - VirtualAlloc2
+// - VirtualAllocExNuma
+// - MapViewOfFile3
+// - OpenFileMappingA
+// - FlushViewOfFile
+#if defined(_MSC_VER) && defined(MEM_RESERVE_PLACEHOLDER)
+#pragma comment(lib, "onecore.lib")
+#endif
+#elif defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+// - O_CREAT
+// - FD_CLOEXEC
+// - O_NONBLOCK
+// - fcntl
+// - open
+#include <sys/mman.h>
+// - madvise
+// - mmap
+// - msync
+// - shm_open
+// - shm_unlink
+#include <sys/stat.h>
+// - fstat
+#include <sys/syscall.h>
+// - SYS_mbind
+// - SYS_memfd_create
+#include <sys/uio.h>
+// - iovec
+// - readv
+// - writev
+#include <unistd.h>
+// - ftruncate
+// - pipe
+// - read
+// - sysconf
+// - write
+#if defined(__linux__)
+#include <sys/eventfd.h>
+// - eventfd
+#endif
+#endif
+
+namespace
+{
+  // Value of mask_ when the capacity isn't a power of two
+  const std::uint64_t NO_MASK = ~static_cast<std::uint64_t>(0);
+
+  // Deadline that has always passed, non-blocking helpers use it to check
+  // their conditions once
+  const Ring_::time_point IMMEDIATELY = Ring_::time_point::min();
+
+  // Largest header a measured read block can have
+  const std::size_t MAX_HEADER = 16;
+
+  // Values of a pending entry's start when it's free and while it's being
+  // filled, positions never get this large
+  const std::uint64_t EMPTY_PENDING = ~static_cast<std::uint64_t>(0);
+  const std::uint64_t BUSY_PENDING  = ~static_cast<std::uint64_t>(1);
+
+  // Picks a pending entry for a position. Blocks are often the same size, so
+  // the position is mixed to spread them across the table
+  std::size_t hash_position(std::uint64_t pos, int bits)
+  {
+    return static_cast<std::size_t>((pos * 0x9E3779B97F4A7C15ull) >> (64 - bits));
+  }
+
+  // Returns the size rounded up to a power of two if it is requested
+  std::size_t round_size(std::size_t size, const RingOptions& options)
+  {
+    if (!options.power_of_two || size == 0)
+      return size;
+
+    std::size_t rounded = 1;
+    while (rounded < size)
+      rounded <<= 1;
+
+    return rounded;
+  }
+
+  // The buffer of a mirrored ring is mapped twice, back to back, so that any
+  // block is contiguous in memory even if it wraps around the end. The size
+  // must be a multiple of mirror_granularity(). map_mirrored returns nullptr
+  // if the platform doesn't support it or the mapping fails.
+
+#if defined(_WIN32) && defined(MEM_RESERVE_PLACEHOLDER)
+
+  std::size_t mirror_granularity()
+  {
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return static_cast<std::size_t>(info.dwAllocationGranularity);
+  }
+
+  char* map_mirrored(std::size_t size)
+  {
+    auto high = static_cast<DWORD>(static_cast<unsigned long long>(size) >> 32);
+    auto low  = static_cast<DWORD>(static_cast<unsigned long long>(size) & 0xFFFFFFFF);
+    auto section = CreateFileMappingW(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, high, low, nullptr);
+    if (section == nullptr)
+      return nullptr;
+
+    // Reserve a placeholder for both views and split it in two, each view
+    // then replaces one of the halves
+
+    char* ptr = nullptr;
+    auto base = static_cast<char*>(VirtualAlloc2(nullptr, nullptr, 2 * size, MEM_RESERVE | MEM_RESERVE_PLACEHOLDER, PAGE_NOACCESS, nullptr, 0));
+    if (base != nullptr)
+    {
+      VirtualFree(base, size, MEM_RELEASE | MEM_PRESERVE_PLACEHOLDER);
+
+      auto first  = MapViewOfFile3(section, nullptr, base, 0, size, MEM_REPLACE_PLACEHOLDER, PAGE_READWRITE, nullptr, 0);
+      auto second = MapViewOfFile3(section, nullptr, base + size, 0, size, MEM_REPLACE_PLACEHOLDER, PAGE_READWRITE, nullptr, 0);
+      if (first != nullptr && second != nullptr)
+      {
+        ptr = base;
+      }
+      else
+      {
+        if (first != nullptr)
+          UnmapViewOfFile(first);
+        else
+          VirtualFree(base, 0, MEM_RELEASE);
+
+        if (second != nullptr)
+          UnmapViewOfFile(second);
+        else
+          VirtualFree(base + size, 0, MEM_RELEASE);
+      }
+    }
+
+    CloseHandle(section);
+    return ptr;
+  }
+
+  void unmap_mirrored(char* ptr, std::size_t size)
+  {
+    UnmapViewOfFile(ptr);
+    UnmapViewOfFile(ptr + size);
+  }
+
+#elif defined(__unix__) || defined(__APPLE__)
+
+  std::size_t mirror_granularity()
+  {
+    return static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+  }
+
+  // Opens an anonymous file that can be mapped, a memfd if possible and an
+  // unlinked shared memory object otherwise
+  int open_anonymous_file()
+  {
+#if defined(__linux__) && defined(SYS_memfd_create)
+    auto fd = static_cast<int>(syscall(SYS_memfd_create, "wilt-ring", 1u)); // MFD_CLOEXEC
+    if (fd != -1)
+      return fd;
+#endif
+
+    static std::atomic<unsigned> counter(0);
+
+    char name[64];
+    std::snprintf(name, sizeof(name), "/wilt-ring-%ld-%u", static_cast<long>(getpid()), counter++);
+
+    auto shm = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (shm != -1)
+      shm_unlink(name);
+
+    return shm;
+  }
+
+  char* map_mirrored(std::size_t size)
+  {
+    auto fd = open_anonymous_file();
+    if (fd == -1)
+      return nullptr;
+
+    // Reserve address space for both mappings, then map the file over each
+    // half of it
+
+    char* ptr = nullptr;
+    if (ftruncate(fd, static_cast<off_t>(size)) == 0)
+    {
+      auto addr = mmap(nullptr, 2 * size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+      if (addr != MAP_FAILED)
+      {
+        auto base = static_cast<char*>(addr);
+        if (mmap(base, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) != MAP_FAILED &&
+            mmap(base + size, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) != MAP_FAILED)
+          ptr = base;
+        else
+          munmap(addr, 2 * size);
+      }
+    }
+
+    close(fd);
+    return ptr;
+  }
+
+  void unmap_mirrored(char* ptr, std::size_t size)
+  {
+    munmap(ptr, 2 * size);
+  }
+
+#else
+
+  std::size_t mirror_granularity()
+  {
+    return 1;
+  }
+
+  char* map_mirrored(std::size_t)
+  {
+    return nullptr;
+  }
+
+  void unmap_mirrored(char*, std::size_t)
+  { }
+
+#endif
+
+  // Buffers that need more than new[] gives (alignment, huge pages, a NUMA
+  // node or prefaulting) are mapped directly. map_pages returns nullptr if
+  // the platform doesn't support it or the mapping fails, and sets 'mapped'
+  // to the size that must be given to unmap_pages. Huge pages and binding
+  // to a node are only hints, so falling back without them isn't an error.
+
+  // Size of the huge pages tried first, and the alignment that lets the
+  // kernel back the buffer with transparent huge pages otherwise
+  const std::size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+  std::size_t round_up(std::size_t size, std::size_t granularity)
+  {
+    return (size + granularity - 1) / granularity * granularity;
+  }
+
+#if defined(_WIN32)
+
+  std::size_t page_size()
+  {
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return static_cast<std::size_t>(info.dwPageSize);
+  }
+
+  char* map_pages(std::size_t size, const RingOptions& options, std::size_t& mapped)
+  {
+    // Large pages need the SeLockMemoryPrivilege, so the allocation is tried
+    // again without them if it fails
+
+    auto process = GetCurrentProcess();
+    auto node = options.numa_node >= 0 ? static_cast<DWORD>(options.numa_node) : NUMA_NO_PREFERRED_NODE;
+    auto large = GetLargePageMinimum();
+    if (options.huge_pages && large != 0)
+    {
+      auto rounded = round_up(size, large);
+      auto ptr = VirtualAllocExNuma(process, nullptr, rounded, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE, node);
+      if (ptr != nullptr)
+      {
+        mapped = rounded;
+        return static_cast<char*>(ptr);
+      }
+    }
+
+    mapped = round_up(size, page_size());
+    return static_cast<char*>(VirtualAllocExNuma(process, nullptr, mapped, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE, node));
+  }
+
+  void unmap_pages(char* ptr, std::size_t)
+  {
+    VirtualFree(ptr, 0, MEM_RELEASE);
+  }
+
+  void bind_node(char*, std::size_t, int)
+  {
+    // Mirrored sections can't be given a node, mapped pages get theirs when
+    // they are allocated
+  }
+
+#elif defined(__unix__) || defined(__APPLE__)
+
+  std::size_t page_size()
+  {
+    return static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+  }
+
+  char* map_pages(std::size_t size, const RingOptions& options, std::size_t& mapped)
+  {
+#if defined(MAP_HUGETLB)
+    if (options.huge_pages)
+    {
+      auto rounded = round_up(size, HUGE_PAGE_SIZE);
+      auto addr = mmap(nullptr, rounded, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+      if (addr != MAP_FAILED)
+      {
+        mapped = rounded;
+        return static_cast<char*>(addr);
+      }
+    }
+#endif
+
+    // Alignments larger than a page are made by mapping extra space and
+    // unmapping what is left on either side of the aligned range
+
+    auto page = page_size();
+    auto alignment = options.alignment > page ? options.alignment : page;
+    if (options.huge_pages && alignment < HUGE_PAGE_SIZE)
+      alignment = HUGE_PAGE_SIZE;
+
+    auto rounded = round_up(size, page);
+    auto length = rounded + alignment - page;
+    auto addr = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (addr == MAP_FAILED)
+      return nullptr;
+
+    auto base = static_cast<char*>(addr);
+    auto offset = (alignment - reinterpret_cast<std::uintptr_t>(base) % alignment) % alignment;
+    if (offset != 0)
+      munmap(base, offset);
+    if (length - offset != rounded)
+      munmap(base + offset + rounded, length - offset - rounded);
+
+#if defined(MADV_HUGEPAGE)
+    if (options.huge_pages)
+      madvise(base + offset, rounded, MADV_HUGEPAGE);
+#endif
+
+    mapped = rounded;
+    return base + offset;
+  }
+
+  void unmap_pages(char* ptr, std::size_t mapped)
+  {
+    munmap(ptr, mapped);
+  }
+
+  void bind_node(char* ptr, std::size_t size, int node)
+  {
+#if defined(__linux__) && defined(SYS_mbind)
+    // Calls mbind directly with MPOL_BIND (2) so that libnuma isn't needed
+
+    const std::size_t BITS = sizeof(unsigned long) * CHAR_BIT;
+    unsigned long nodes[16] = { };
+    if (static_cast<std::size_t>(node) >= 16 * BITS - 1)
+      return;
+
+    nodes[node / BITS] |= 1ul << (node % BITS);
+    syscall(SYS_mbind, ptr, static_cast<unsigned long>(size), 2, nodes, static_cast<unsigned long>(16 * BITS), 0u);
+#else
+    (void)ptr;
+    (void)size;
+    (void)node;
+#endif
+  }
+
+#else
+
+  std::size_t page_size()
+  {
+    return 4096;
+  }
+
+  char* map_pages(std::size_t, const RingOptions&, std::size_t&)
+  {
+    return nullptr;
+  }
+
+  void unmap_pages(char*, std::size_t)
+  { }
+
+  void bind_node(char*, std::size_t, int)
+  { }
+
+#endif
+
+  // Writes to every page so they are faulted in now rather than by the first
+  // operations that use them (binding to a node must happen before this)
+  void prefault(char* ptr, std::size_t size)
+  {
+    auto page = page_size();
+    for (std::size_t i = 0; i < size; i += page)
+      static_cast<volatile char*>(ptr)[i] = 0;
+  }
+
+  // Shared rings live in named segments. create_segment fails if the name
+  // already exists, open_segment sets 'size' to the size of the segment.
+  // File rings map the whole file, which is sized to 'size' if it is empty
+  // ('created' is set then).
+
+#if defined(_WIN32)
+
+  char* create_segment(const char* name, std::size_t size)
+  {
+    auto high = static_cast<DWORD>(static_cast<unsigned long long>(size) >> 32);
+    auto low  = static_cast<DWORD>(static_cast<unsigned long long>(size) & 0xFFFFFFFF);
+    auto mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, high, low, name);
+    if (mapping == nullptr)
+      return nullptr;
+
+    void* ptr = nullptr;
+    if (GetLastError() != ERROR_ALREADY_EXISTS)
+      ptr = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, size);
+
+    // The view keeps the mapping (and its name) alive
+    CloseHandle(mapping);
+    return static_cast<char*>(ptr);
+  }
+
+  char* open_segment(const char* name, std::size_t& size)
+  {
+    auto mapping = OpenFileMappingA(FILE_MAP_ALL_ACCESS, FALSE, name);
+    if (mapping == nullptr)
+      return nullptr;
+
+    auto ptr = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, 0);
+    CloseHandle(mapping);
+    if (ptr == nullptr)
+      return nullptr;
+
+    MEMORY_BASIC_INFORMATION info;
+    VirtualQuery(ptr, &info, sizeof(info));
+    size = static_cast<std::size_t>(info.RegionSize);
+    return static_cast<char*>(ptr);
+  }
+
+  void unmap_segment(char* ptr, std::size_t)
+  {
+    UnmapViewOfFile(ptr);
+  }
+
+  bool remove_segment(const char*)
+  {
+    // Mappings are removed once nothing uses them
+    return true;
+  }
+
+  char* open_file_segment(const char* path, std::size_t size, std::size_t& mapped, bool& created)
+  {
+    auto file = CreateFileA(path, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+      return nullptr;
+
+    LARGE_INTEGER existing;
+    if (!GetFileSizeEx(file, &existing))
+    {
+      CloseHandle(file);
+      return nullptr;
+    }
+
+    created = existing.QuadPart == 0;
+    mapped = created ? size : static_cast<std::size_t>(existing.QuadPart);
+
+    auto high = static_cast<DWORD>(static_cast<unsigned long long>(mapped) >> 32);
+    auto low  = static_cast<DWORD>(static_cast<unsigned long long>(mapped) & 0xFFFFFFFF);
+    auto mapping = CreateFileMappingA(file, nullptr, PAGE_READWRITE, high, low, nullptr);
+    CloseHandle(file);
+    if (mapping == nullptr)
+      return nullptr;
+
+    auto ptr = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, mapped);
+    CloseHandle(mapping);
+    return static_cast<char*>(ptr);
+  }
+
+  // Writes the dirty pages of the range to the file. Without the file handle
+  // the file's metadata isn't flushed with FlushFileBuffers
+  void sync_segment(char* ptr, std::size_t size)
+  {
+    FlushViewOfFile(ptr, size);
+  }
+
+#elif defined(__unix__) || defined(__APPLE__)
+
+  char* create_segment(const char* name, std::size_t size)
+  {
+    auto fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd == -1)
+      return nullptr;
+
+    char* ptr = nullptr;
+    if (ftruncate(fd, static_cast<off_t>(size)) == 0)
+    {
+      auto addr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+      if (addr != MAP_FAILED)
+        ptr = static_cast<char*>(addr);
+    }
+
+    close(fd);
+    if (ptr == nullptr)
+      shm_unlink(name);
+
+    return ptr;
+  }
+
+  char* open_segment(const char* name, std::size_t& size)
+  {
+    auto fd = shm_open(name, O_RDWR, 0);
+    if (fd == -1)
+      return nullptr;
+
+    char* ptr = nullptr;
+    struct stat info;
+    if (fstat(fd, &info) == 0 && info.st_size > 0)
+    {
+      size = static_cast<std::size_t>(info.st_size);
+      auto addr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+      if (addr != MAP_FAILED)
+        ptr = static_cast<char*>(addr);
+    }
+
+    close(fd);
+    return ptr;
+  }
+
+  void unmap_segment(char* ptr, std::size_t size)
+  {
+    munmap(ptr, size);
+  }
+
+  bool remove_segment(const char* name)
+  {
+    return shm_unlink(name) == 0;
+  }
+
+  char* open_file_segment(const char* path, std::size_t size, std::size_t& mapped, bool& created)
+  {
+    auto fd = open(path, O_RDWR | O_CREAT, 0644);
+    if (fd == -1)
+      return nullptr;
+
+    char* ptr = nullptr;
+    struct stat info;
+    if (fstat(fd, &info) == 0)
+    {
+      created = info.st_size == 0;
+      mapped = created ? size : static_cast<std::size_t>(info.st_size);
+      if (!created || ftruncate(fd, static_cast<off_t>(size)) == 0)
+      {
+        auto addr = mmap(nullptr, mapped, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (addr != MAP_FAILED)
+          ptr = static_cast<char*>(addr);
+      }
+    }
+
+    close(fd);
+    return ptr;
+  }
+
+  // Writes the dirty pages of the range to the file, msync needs the start
+  // to be on a page boundary
+  void sync_segment(char* ptr, std::size_t size)
+  {
+    auto page = page_size();
+    auto offset = reinterpret_cast<std::uintptr_t>(ptr) % page;
+    msync(ptr - offset, size + offset, MS_SYNC);
+  }
+
+#else
+
+  char* create_segment(const char*, std::size_t)
+  {
+    return nullptr;
+  }
+
+  char* open_segment(const char*, std::size_t&)
+  {
+    return nullptr;
+  }
+
+  void unmap_segment(char*, std::size_t)
+  { }
+
+  bool remove_segment(const char*)
+  {
+    return false;
+  }
+
+  char* open_file_segment(const char*, std::size_t, std::size_t&, bool&)
+  {
+    return nullptr;
+  }
+
+  void sync_segment(char*, std::size_t)
+  { }
+
+#endif
+
+  // Readiness events are an eventfd on Linux, a pipe on other systems (its
+  // read end is polled) and a manual-reset event on Windows. open_event
+  // sets 'handle' to NO_EVENT if it fails
+
+#if defined(_WIN32)
+
+  const Ring_::event_handle NO_EVENT = nullptr;
+
+  void open_event(Ring_::event_handle& handle, Ring_::event_handle& signal)
+  {
+    handle = CreateEventA(nullptr, TRUE, FALSE, nullptr);
+    signal = handle;
+  }
+
+  void signal_event(Ring_::event_handle signal)
+  {
+    SetEvent(signal);
+  }
+
+  void clear_event(Ring_::event_handle handle)
+  {
+    ResetEvent(handle);
+  }
+
+  void close_event(Ring_::event_handle handle, Ring_::event_handle)
+  {
+    CloseHandle(handle);
+  }
+
+#elif defined(__unix__) || defined(__APPLE__)
+
+  const Ring_::event_handle NO_EVENT = -1;
+
+  void open_event(Ring_::event_handle& handle, Ring_::event_handle& signal)
+  {
+#if defined(__linux__)
+    handle = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    signal = handle;
+#else
+    int fds[2];
+    handle = NO_EVENT;
+    if (pipe(fds) != 0)
+      return;
+
+    for (auto fd : fds)
+    {
+      fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+      fcntl(fd, F_SETFD, FD_CLOEXEC);
+    }
+    handle = fds[0];
+    signal = fds[1];
+#endif
+  }
+
+  // A full pipe or eventfd counter fails the write, but is already readable
+
+  void signal_event(Ring_::event_handle signal)
+  {
+    std::uint64_t one = 1;
+    while (write(signal, &one, sizeof(one)) == -1 && errno == EINTR)
+      ;
+  }
+
+  void clear_event(Ring_::event_handle handle)
+  {
+    std::uint64_t value[8];
+    ssize_t count;
+    do
+      count = read(handle, value, sizeof(value));
+    while (count > 0 || (count == -1 && errno == EINTR));
+  }
+
+  void close_event(Ring_::event_handle handle, Ring_::event_handle signal)
+  {
+    close(handle);
+    if (signal != handle)
+      close(signal);
+  }
+
+#else
+
+  const Ring_::event_handle NO_EVENT = -1;
+
+  void open_event(Ring_::event_handle& handle, Ring_::event_handle&)
+  {
+    handle = NO_EVENT;
+  }
+
+  void signal_event(Ring_::event_handle)
+  { }
+
+  void clear_event(Ring_::event_handle)
+  { }
+
+  void close_event(Ring_::event_handle, Ring_::event_handle)
+  { }
+
+#endif
+
+  // Moves data between a file descriptor and a block of up to two spans,
+  // returning what readv or writev returned. Windows has no descriptors to
+  // gather into, so the calls fail there
+
+#if defined(__unix__) || defined(__APPLE__)
+
+  std::ptrdiff_t read_spans(int fd, char* first, std::size_t first_size, char* second, std::size_t second_size)
+  {
+    iovec spans[2] = { { first, first_size }, { second, second_size } };
+    ssize_t count;
+    do
+      count = readv(fd, spans, second_size > 0 ? 2 : 1);
+    while (count == -1 && errno == EINTR);
+
+    return count;
+  }
+
+  std::ptrdiff_t write_spans(int fd, const char* first, std::size_t first_size, const char* second, std::size_t second_size)
+  {
+    iovec spans[2] = { { const_cast<char*>(first), first_size }, { const_cast<char*>(second), second_size } };
+    ssize_t count;
+    do
+      count = writev(fd, spans, second_size > 0 ? 2 : 1);
+    while (count == -1 && errno == EINTR);
+
+    return count;
+  }
+
+#else
+
+  std::ptrdiff_t read_spans(int, char*, std::size_t, char*, std::size_t)
+  {
+    errno = ENOSYS;
+    return -1;
+  }
+
+  std::ptrdiff_t write_spans(int, const char*, std::size_t, const char*, std::size_t)
+  {
+    errno = ENOSYS;
+    return -1;
+  }
+
+#endif
+
+  // Copies with non-temporal stores, which write around the cache so a large
+  // block doesn't evict the writer's working set for data that a reader on
+  // another core will load anyway. The destination is aligned with memcpy
+  // first, and the fence orders the stores before the commit publishes them.
+  // The kernel is picked once from what the cpu supports, other platforms
+  // just use memcpy
+
+#if defined(__x86_64__) || defined(_M_X64)
+
+#if defined(__GNUC__)
+#define WILT_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define WILT_TARGET_AVX2
+#endif
+
+  void stream_copy_sse2(char* dst, const char* src, std::size_t length)
+  {
+    auto head = (16 - reinterpret_cast<std::uintptr_t>(dst) % 16) % 16;
+    if (head > length)
+      head = length;
+    std::memcpy(dst, src, head);
+    dst += head; src += head; length -= head;
+
+    for (; length >= 64; dst += 64, src += 64, length -= 64)
+    {
+      auto a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+      auto b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 16));
+      auto c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 32));
+      auto d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 48));
+      _mm_stream_si128(reinterpret_cast<__m128i*>(dst), a);
+      _mm_stream_si128(reinterpret_cast<__m128i*>(dst + 16), b);
+      _mm_stream_si128(reinterpret_cast<__m128i*>(dst + 32), c);
+      _mm_stream_si128(reinterpret_cast<__m128i*>(dst + 48), d);
+    }
+
+    _mm_sfence();
+    std::memcpy(dst, src, length);
+  }
+
+  WILT_TARGET_AVX2
+  void stream_copy_avx2(char* dst, const char* src, std::size_t length)
+  {
+    auto head = (32 - reinterpret_cast<std::uintptr_t>(dst) % 32) % 32;
+    if (head > length)
+      head = length;
+    std::memcpy(dst, src, head);
+    dst += head; src += head; length -= head;
+
+    for (; length >= 128; dst += 128, src += 128, length -= 128)
+    {
+      auto a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src));
+      auto b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + 32));
+      auto c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + 64));
+      auto d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + 96));
+      _mm256_stream_si256(reinterpret_cast<__m256i*>(dst), a);
+      _mm256_stream_si256(reinterpret_cast<__m256i*>(dst + 32), b);
+      _mm256_stream_si256(reinterpret_cast<__m256i*>(dst + 64), c);
+      _mm256_stream_si256(reinterpret_cast<__m256i*>(dst + 96), d);
+    }
+
+    _mm_sfence();
+    std::memcpy(dst, src, length);
+  }
+
+  bool has_avx2()
+  {
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7)
+      return false;
+
+    __cpuid(info, 1);
+    if ((info[2] & (1 << 27)) == 0 || (_xgetbv(0) & 6) != 6)
+      return false;                                         // no OS support
+
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+  }
+
+#undef WILT_TARGET_AVX2
+
+  typedef void (*copy_kernel)(char*, const char*, std::size_t);
+
+  void stream_copy(char* dst, const char* src, std::size_t length)
+  {
+    static const copy_kernel kernel = has_avx2() ? stream_copy_avx2 : stream_copy_sse2;
+    kernel(dst, src, length);
+  }
+
+#else
+
+  void stream_copy(char* dst, const char* src, std::size_t length)
+  {
+    std::memcpy(dst, src, length);
+  }
+
+#endif
+
+  // Identifies a shared segment as a ring ("WILTRING"), and the version of
+  // its layout, which changes whenever the header or control_ does
+  const std::uint64_t SHARED_MAGIC   = 0x474E4952544C4957ull;
+  const std::uint32_t SHARED_VERSION = 4;
+
+  const std::uint32_t SHARED_SINGLE_PRODUCER = 1;
+  const std::uint32_t SHARED_SINGLE_CONSUMER = 2;
+  const std::uint32_t SHARED_OVERWRITE       = 4;
+
+} // namespace
+
+detail::Waiter::Waiter(WaitStrategy strategy)
+  : strategy_(strategy)
+{
+  std::atomic_init(&waiters_, 0);
+  std::atomic_init(&wakes_, static_cast<std::uint64_t>(0));
+}
+
+void detail::Waiter::notify()
+{
+  if (strategy_ != WaitStrategy::block)
+    return;
+
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (waiters_.load() == 0)
+    return;
+
+  wakes_.fetch_add(1);
+  std::lock_guard<std::mutex> lock(lock_);
+  cond_.notify_all();
+}
+
+void detail::Waiter::relax()
+{
+#if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+  _mm_pause();
+#elif defined(__i386__) || defined(__x86_64__)
+  __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+  __asm__ __volatile__("yield");
+#endif
+}
+
+struct Ring_::event_set_
+{
+  struct event_
+  {
+    event_handle      handle;   // polled or waited on
+    event_handle      signal;   // written to signal it (the pipe's write end)
+    std::atomic<bool> signaled; // whether it's ready
+  };
+
+  event_ read;  // signaled by write commits
+  event_ write; // signaled by read commits
+
+  // Creates the events, the write event ready since the ring has space
+  event_set_();
+  ~event_set_();
+
+  bool valid() const { return read.handle != NO_EVENT && write.handle != NO_EVENT; }
+};
+
+Ring_::event_set_::event_set_()
+{
+  open_event(read.handle, read.signal);
+  open_event(write.handle, write.signal);
+  std::atomic_init(&read.signaled, false);
+  std::atomic_init(&write.signaled, true);
+
+  if (write.handle != NO_EVENT)
+    signal_event(write.signal);
+}
+
+Ring_::event_set_::~event_set_()
+{
+  if (read.handle != NO_EVENT)
+    close_event(read.handle, read.signal);
+  if (write.handle != NO_EVENT)
+    close_event(write.handle, write.signal);
+}
+
+Ring_::control_::control_()
+{
+  std::atomic_init(&rptr, static_cast<std::uint64_t>(0));
+  std::atomic_init(&rcache, static_cast<std::uint64_t>(0));
+  std::atomic_init(&rbuf, static_cast<std::uint64_t>(0));
+  std::atomic_init(&wbuf, static_cast<std::uint64_t>(0));
+  std::atomic_init(&wcache, static_cast<std::uint64_t>(0));
+  std::atomic_init(&dropped, static_cast<std::uint64_t>(0));
+  std::atomic_init(&wptr, static_cast<std::uint64_t>(0));
+  for (auto& entry : reads)
+  {
+    std::atomic_init(&entry.start, EMPTY_PENDING);
+    std::atomic_init(&entry.end, static_cast<std::uint64_t>(0));
+  }
+  for (auto& entry : writes)
+  {
+    std::atomic_init(&entry.start, EMPTY_PENDING);
+    std::atomic_init(&entry.end, static_cast<std::uint64_t>(0));
+  }
+}
+
+void Ring_::control_::assign(const control_& control)
+{
+  rptr.store(control.rptr.load());
+  rcache.store(control.rcache.load());
+  rbuf.store(control.rbuf.load());
+  wbuf.store(control.wbuf.load());
+  wcache.store(control.wcache.load());
+  dropped.store(control.dropped.load());
+  wptr.store(control.wptr.load());
+  for (int i = 0; i < PENDING; ++i)
+  {
+    reads[i].start.store(control.reads[i].start.load());
+    reads[i].end.store(control.reads[i].end.load());
+    writes[i].start.store(control.writes[i].start.load());
+    writes[i].end.store(control.writes[i].end.load());
+  }
+}
+
 Ring_::Ring_()
   : beg_(nullptr)
   , end_(nullptr)
+  , mask_(0)
+  , mirrored_(false)
+  , mapped_(0)
+  , shared_(nullptr)
+  , ctl_(&own_)
+  , own_()
+  , single_producer_(false)
+  , single_consumer_(false)
+  , overwrite_(false)
+  , streaming_(0)
+  , drop_header_(0)
+  , drop_measure_(nullptr)
+  , flush_(FlushPolicy::none)
+  , flush_interval_(0)
+  , waiter_(WaitStrategy::spin)
+  , events_(nullptr)
+{
+  std::atomic_init(&lap_, static_cast<std::uint64_t>(0));
+  std::atomic_init(&next_flush_, static_cast<std::int64_t>(0));
+  std::atomic_init(&async_waiters_, static_cast<async_waiter_*>(nullptr));
+  reset_stats();
+}
+
+Ring_::Ring_(std::size_t size)
+  : Ring_(size, RingOptions())
+{ }
+
+Ring_::Ring_(std::size_t size, const RingOptions& options)
+  : beg_(nullptr)
+  , end_(nullptr)
+  , mask_(0)
+  , mirrored_(false)
+  , mapped_(0)
+  , shared_(nullptr)
+  , ctl_(&own_)
+  , own_()
+  , single_producer_(options.single_producer)
+  , single_consumer_(options.single_consumer && !options.overwrite)
+  , overwrite_(options.overwrite)
+  , streaming_(options.streaming_threshold)
+  , drop_header_(0)
+  , drop_measure_(nullptr)
+  , flush_(FlushPolicy::none)
+  , flush_interval_(0)
+  , waiter_(options.wait)
+  , events_(nullptr)
+{
+  allocate_(round_size(size, options), options);
+
+  size = capacity();
+  mask_ = (size & (size - 1)) == 0 ? size - 1 : NO_MASK;
+
+  std::atomic_init(&lap_, static_cast<std::uint64_t>(0));
+  std::atomic_init(&next_flush_, static_cast<std::int64_t>(0));
+  std::atomic_init(&async_waiters_, static_cast<async_waiter_*>(nullptr));
+  reset_stats();
+
+  if (options.events)
+    create_events_();
+}
+
+Ring_::Ring_(Ring_&& ring)
+  : beg_(ring.beg_)
+  , end_(ring.end_)
+  , mask_(ring.mask_)
+  , mirrored_(ring.mirrored_)
+  , mapped_(ring.mapped_)
+  , shared_(ring.shared_)
+  , ctl_(ring.shared_ != nullptr ? ring.ctl_ : &own_)
+  , own_()
+  , single_producer_(ring.single_producer_)
+  , single_consumer_(ring.single_consumer_)
+  , overwrite_(ring.overwrite_)
+  , streaming_(ring.streaming_)
+  , drop_header_(ring.drop_header_)
+  , drop_measure_(ring.drop_measure_)
+  , flush_(ring.flush_)
+  , flush_interval_(ring.flush_interval_)
+  , waiter_(ring.waiter_.strategy())
+  , events_(ring.events_)
+{
+  own_.assign(ring.own_);
+  std::atomic_init(&lap_, ring.lap_.load());
+  std::atomic_init(&next_flush_, ring.next_flush_.load());
+  std::atomic_init(&async_waiters_, static_cast<async_waiter_*>(nullptr));
+  reset_stats();
+
+  ring.beg_ = nullptr;
+  ring.end_ = nullptr;
+  ring.mask_ = 0;
+  ring.lap_ = 0;
+  ring.mirrored_ = false;
+  ring.mapped_ = 0;
+  ring.shared_ = nullptr;
+  ring.ctl_ = &ring.own_;
+  ring.own_.assign(control_());
+  ring.flush_ = FlushPolicy::none;
+  ring.events_ = nullptr;
+}
+
+Ring_& Ring_::operator= (Ring_&& ring)
+{
+  deallocate_();
+
+  beg_ = ring.beg_;
+  end_ = ring.end_;
+  mask_ = ring.mask_;
+  lap_ = ring.lap_.load();
+  mirrored_ = ring.mirrored_;
+  mapped_ = ring.mapped_;
+  shared_ = ring.shared_;
+  ctl_ = ring.shared_ != nullptr ? ring.ctl_ : &own_;
+  waiter_.set_strategy(ring.waiter_.strategy());
+  single_producer_ = ring.single_producer_;
+  single_consumer_ = ring.single_consumer_;
+  overwrite_ = ring.overwrite_;
+  streaming_ = ring.streaming_;
+  drop_header_ = ring.drop_header_;
+  drop_measure_ = ring.drop_measure_;
+  flush_ = ring.flush_;
+  flush_interval_ = ring.flush_interval_;
+  next_flush_.store(ring.next_flush_.load());
+  delete events_;
+  events_ = ring.events_;
+
+  own_.assign(ring.own_);
+
+  ring.beg_ = nullptr;
+  ring.end_ = nullptr;
+  ring.mask_ = 0;
+  ring.lap_ = 0;
+  ring.mirrored_ = false;
+  ring.mapped_ = 0;
+  ring.shared_ = nullptr;
+  ring.ctl_ = &ring.own_;
+  ring.own_.assign(control_());
+  ring.flush_ = FlushPolicy::none;
+  ring.events_ = nullptr;
+
+  return *this;
+}
+
+Ring_::~Ring_()
+{
+  deallocate_();
+  delete events_;
+}
+
+std::size_t Ring_::size() const
+{
+  // Reads can only claim committed data, so loading the read position first
+  // means the write position is never behind it.
+
+  auto rptr = ctl_->rptr.load();
+  auto wptr = ctl_->wptr.load();
+  return static_cast<std::size_t>(wptr - rptr);
+}
+
+std::size_t Ring_::capacity() const
+{
+  return static_cast<std::size_t>(end_ - beg_);
+}
+
+bool Ring_::mirrored() const
+{
+  return mirrored_;
+}
+
+bool Ring_::shared() const
+{
+  return shared_ != nullptr;
+}
+
+std::uint64_t Ring_::dropped() const
+{
+  return ctl_->dropped.load(std::memory_order_relaxed);
+}
+
+Ring_::event_handle Ring_::read_event() const
+{
+  return events_ != nullptr ? events_->read.handle : NO_EVENT;
+}
+
+Ring_::event_handle Ring_::write_event() const
+{
+  return events_ != nullptr ? events_->write.handle : NO_EVENT;
+}
+
+RingStats Ring_::stats() const
+{
+  RingStats stats;
+#ifdef WILT_RING_STATS
+  std::uint64_t counts[STAT_COUNT] = { };
+  for (auto& stripe : stats_)
+    for (int i = 0; i < STAT_COUNT; ++i)
+      counts[i] += stripe.counts[i].load(std::memory_order_relaxed);
+
+  stats.read_retries  = counts[STAT_READ_RETRIES];
+  stats.write_retries = counts[STAT_WRITE_RETRIES];
+  stats.empty_stalls  = counts[STAT_EMPTY_STALLS];
+  stats.full_stalls   = counts[STAT_FULL_STALLS];
+  stats.wait_spins    = counts[STAT_WAIT_SPINS];
+  stats.release_waits = counts[STAT_RELEASE_WAITS];
+  stats.high_water    = high_water_.load(std::memory_order_relaxed);
+#endif
+  return stats;
+}
+
+void Ring_::reset_stats()
+{
+#ifdef WILT_RING_STATS
+  for (auto& stripe : stats_)
+    for (auto& count : stripe.counts)
+      count.store(0, std::memory_order_relaxed);
+
+  high_water_.store(0, std::memory_order_relaxed);
+#endif
+}
+
+void Ring_::read(void* data, std::size_t length) noexcept
+{
+  std::uint64_t pos;
+  auto block = acquire_read_block_(length, pos);
+
+  copy_read_block_(block, (char*)data, length);
+  release_read_block_(pos, length);
+}
+
+void Ring_::write(const void* data, std::size_t length) noexcept
+{
+  std::uint64_t pos;
+  auto block = acquire_write_block_(length, pos);
+
+  copy_write_block_(block, (const char*)data, length);
+  release_write_block_(pos, length);
+}
+
+bool Ring_::read_until(void* data, std::size_t length, time_point deadline) noexcept
+{
+  std::uint64_t pos;
+  auto block = acquire_read_block_(length, pos, &deadline);
+  if (block == nullptr)
+    return false;
+
+  copy_read_block_(block, (char*)data, length);
+  release_read_block_(pos, length);
+
+  return true;
+}
+
+bool Ring_::write_until(const void* data, std::size_t length, time_point deadline) noexcept
+{
+  std::uint64_t pos;
+  auto block = acquire_write_block_(length, pos, &deadline);
+  if (block == nullptr)
+    return false;
+
+  copy_write_block_(block, (const char*)data, length);
+  release_write_block_(pos, length);
+
+  return true;
+}
+
+bool Ring_::try_read(void* data, std::size_t length) noexcept
+{
+  std::uint64_t pos;
+  auto block = try_acquire_read_block_(length, pos);
+  if (block == nullptr)
+    return false;
+
+  copy_read_block_(block, (char*)data, length);
+  release_read_block_(pos, length);
+
+  return true;
+}
+
+bool Ring_::try_write(const void* data, std::size_t length) noexcept
+{
+  std::uint64_t pos;
+  auto block = try_acquire_write_block_(length, pos);
+  if (block == nullptr)
+    return false;
+
+  copy_write_block_(block, (const char*)data, length);
+  release_write_block_(pos, length);
+
+  return true;
+}
+
+void Ring_::read(const ReadSegment* segments, std::size_t count) noexcept
+{
+  auto length = segments_length_(segments, count);
+
+  std::uint64_t pos;
+  auto block = acquire_read_block_(length, pos);
+
+  scatter_read_block_(block, segments, count);
+  release_read_block_(pos, length);
+}
+
+void Ring_::write(const WriteSegment* segments, std::size_t count) noexcept
+{
+  auto length = segments_length_(segments, count);
+
+  std::uint64_t pos;
+  auto block = acquire_write_block_(length, pos);
+
+  gather_write_block_(block, segments, count);
+  release_write_block_(pos, length);
+}
+
+bool Ring_::try_read(const ReadSegment* segments, std::size_t count) noexcept
+{
+  auto length = segments_length_(segments, count);
+
+  std::uint64_t pos;
+  auto block = try_acquire_read_block_(length, pos);
+  if (block == nullptr)
+    return false;
+
+  scatter_read_block_(block, segments, count);
+  release_read_block_(pos, length);
+
+  return true;
+}
+
+bool Ring_::try_write(const WriteSegment* segments, std::size_t count) noexcept
+{
+  auto length = segments_length_(segments, count);
+
+  std::uint64_t pos;
+  auto block = try_acquire_write_block_(length, pos);
+  if (block == nullptr)
+    return false;
+
+  gather_write_block_(block, segments, count);
+  release_write_block_(pos, length);
+
+  return true;
+}
+
+void Ring_::clear_read_event()
+{
+  // The event is cleared before the flag so a commit in between still sees
+  // it signaled, the reads that follow see that commit's data
+
+  if (events_ == nullptr)
+    return;
+
+  clear_event(events_->read.handle);
+  events_->read.signaled.store(false);
+}
+
+void Ring_::clear_write_event()
+{
+  if (events_ == nullptr)
+    return;
+
+  clear_event(events_->write.handle);
+  events_->write.signaled.store(false);
+}
+
+std::size_t Ring_::read_some(void* data, std::size_t length) noexcept
+{
+  if (length == 0)
+    return 0;
+
+  std::uint64_t pos;
+  auto block = acquire_some_read_block_(length, 1, pos);
+
+  copy_read_block_(block, (char*)data, length);
+  release_read_block_(pos, length);
+
+  return length;
+}
+
+std::size_t Ring_::try_read_some(void* data, std::size_t length) noexcept
+{
+  std::uint64_t pos;
+  auto block = try_acquire_some_read_block_(length, 1, pos);
+  if (block == nullptr)
+    return 0;
+
+  copy_read_block_(block, (char*)data, length);
+  release_read_block_(pos, length);
+
+  return length;
+}
+
+void Ring_::peek(void* data, std::size_t length) noexcept
+{
+  std::uint64_t pos;
+  do
+    copy_read_block_(peek_block_(length, pos), (char*)data, length);
+  while (!peek_valid_(pos));
+}
+
+bool Ring_::try_peek(void* data, std::size_t length) noexcept
+{
+  std::uint64_t pos;
+  do
+  {
+    auto block = try_peek_block_(length, pos);
+    if (block == nullptr)
+      return false;
+
+    copy_read_block_(block, (char*)data, length);
+  }
+  while (!peek_valid_(pos));
+
+  return true;
+}
+
+void Ring_::skip(std::size_t length) noexcept
+{
+  std::uint64_t pos;
+  acquire_read_block_(length, pos);
+  release_read_block_(pos, length);
+}
+
+bool Ring_::try_skip(std::size_t length) noexcept
+{
+  std::uint64_t pos;
+  if (try_acquire_read_block_(length, pos) == nullptr)
+    return false;
+
+  release_read_block_(pos, length);
+
+  return true;
+}
+
+std::ptrdiff_t Ring_::read_from_fd(int fd, std::size_t max) noexcept
+{
+  // An overwriting ring would drop data to make room before the descriptor
+  // is read, and giving back the unused space doesn't bring it back
+
+  if (!single_producer_ || overwrite_)
+  {
+    errno = EINVAL;
+    return -1;
+  }
+
+  if (max == 0 || capacity() == 0)
+    return 0;
+
+  std::uint64_t pos;
+  auto length = max;
+  auto block = acquire_some_write_block_(length, pos);
+
+  auto tail = static_cast<std::size_t>(end_ - block);
+  auto first = mirrored_ || length <= tail ? length : tail;
+  auto count = read_spans(fd, block, first, beg_, length - first);
+
+  auto used = count > 0 ? static_cast<std::size_t>(count) : 0;
+  if (used < length)
+    shrink_write_block_(pos, used);                         // give back the rest
+
+  if (used > 0)
+    release_write_block_(pos, used);
+
+  return count;
+}
+
+std::ptrdiff_t Ring_::write_to_fd(int fd, std::size_t max) noexcept
+{
+  if (!single_consumer_)
+  {
+    errno = EINVAL;
+    return -1;
+  }
+
+  if (max == 0 || capacity() == 0)
+    return 0;
+
+  std::uint64_t pos;
+  auto length = max;
+  auto block = acquire_some_read_block_(length, 1, pos);
+
+  auto tail = static_cast<std::size_t>(end_ - block);
+  auto first = mirrored_ || length <= tail ? length : tail;
+  auto count = write_spans(fd, block, first, beg_, length - first);
+
+  auto used = count > 0 ? static_cast<std::size_t>(count) : 0;
+  if (used < length)
+    shrink_read_block_(pos, used);                          // give back the rest
+
+  if (used > 0)
+    release_read_block_(pos, used);
+
+  return count;
+}
+
+Ring_::WriteBlock Ring_::reserve_write(std::size_t length) noexcept
+{
+  std::uint64_t pos;
+  auto block = acquire_write_block_(length, pos);
+
+  return WriteBlock(this, block, pos, length);
+}
+
+Ring_::WriteBlock Ring_::try_reserve_write(std::size_t length) noexcept
+{
+  std::uint64_t pos;
+  auto block = try_acquire_write_block_(length, pos);
+  if (block == nullptr)
+    return WriteBlock();
+
+  return WriteBlock(this, block, pos, length);
+}
+
+Ring_::ReadBlock Ring_::reserve_read(std::size_t length) noexcept
+{
+  std::uint64_t pos;
+  auto block = acquire_read_block_(length, pos);
+
+  return ReadBlock(this, block, pos, length);
+}
+
+Ring_::ReadBlock Ring_::try_reserve_read(std::size_t length) noexcept
+{
+  std::uint64_t pos;
+  auto block = try_acquire_read_block_(length, pos);
+  if (block == nullptr)
+    return ReadBlock();
+
+  return ReadBlock(this, block, pos, length);
+}
+
+Ring_::WriteBlock::WriteBlock()
+  : ring_(nullptr)
+  , pos_(0)
+  , first_(nullptr)
+  , first_size_(0)
+  , second_(nullptr)
+  , second_size_(0)
+{ }
+
+Ring_::WriteBlock::WriteBlock(Ring_* ring, char* block, std::uint64_t pos, std::size_t length)
+  : ring_(ring)
+  , pos_(pos)
+  , first_(block)
+  , first_size_(length)
+  , second_(nullptr)
+  , second_size_(0)
+{
+  auto tail = static_cast<std::size_t>(ring->end_ - block);
+  if (length > tail && !ring->mirrored_)
+  {
+    first_size_  = tail;
+    second_      = ring->beg_;
+    second_size_ = length - tail;
+  }
+}
+
+Ring_::WriteBlock::WriteBlock(WriteBlock&& block)
+  : ring_(block.ring_)
+  , pos_(block.pos_)
+  , first_(block.first_)
+  , first_size_(block.first_size_)
+  , second_(block.second_)
+  , second_size_(block.second_size_)
+{
+  block.ring_ = nullptr;
+}
+
+Ring_::WriteBlock& Ring_::WriteBlock::operator= (WriteBlock&& block)
+{
+  commit();
+
+  ring_        = block.ring_;
+  pos_         = block.pos_;
+  first_       = block.first_;
+  first_size_  = block.first_size_;
+  second_      = block.second_;
+  second_size_ = block.second_size_;
+
+  block.ring_ = nullptr;
+
+  return *this;
+}
+
+Ring_::WriteBlock::~WriteBlock()
+{
+  commit();
+}
+
+void Ring_::WriteBlock::commit() noexcept
+{
+  if (ring_ == nullptr)
+    return;
+
+  ring_->release_write_block_(pos_, size());
+
+  ring_        = nullptr;
+  pos_         = 0;
+  first_       = nullptr;
+  first_size_  = 0;
+  second_      = nullptr;
+  second_size_ = 0;
+}
+
+Ring_::ReadBlock::ReadBlock()
+  : ring_(nullptr)
+  , pos_(0)
+  , first_(nullptr)
+  , first_size_(0)
+  , second_(nullptr)
+  , second_size_(0)
+{ }
+
+Ring_::ReadBlock::ReadBlock(Ring_* ring, char* block, std::uint64_t pos, std::size_t length)
+  : ring_(ring)
+  , pos_(pos)
+  , first_(block)
+  , first_size_(length)
+  , second_(nullptr)
+  , second_size_(0)
+{
+  auto tail = static_cast<std::size_t>(ring->end_ - block);
+  if (length > tail && !ring->mirrored_)
+  {
+    first_size_  = tail;
+    second_      = ring->beg_;
+    second_size_ = length - tail;
+  }
+}
+
+Ring_::ReadBlock::ReadBlock(ReadBlock&& block)
+  : ring_(block.ring_)
+  , pos_(block.pos_)
+  , first_(block.first_)
+  , first_size_(block.first_size_)
+  , second_(block.second_)
+  , second_size_(block.second_size_)
+{
+  block.ring_ = nullptr;
+}
+
+Ring_::ReadBlock& Ring_::ReadBlock::operator= (ReadBlock&& block)
+{
+  commit();
+
+  ring_        = block.ring_;
+  pos_         = block.pos_;
+  first_       = block.first_;
+  first_size_  = block.first_size_;
+  second_      = block.second_;
+  second_size_ = block.second_size_;
+
+  block.ring_ = nullptr;
+
+  return *this;
+}
+
+Ring_::ReadBlock::~ReadBlock()
+{
+  commit();
+}
+
+void Ring_::ReadBlock::commit() noexcept
+{
+  if (ring_ == nullptr)
+    return;
+
+  ring_->release_read_block_(pos_, size());
+
+  ring_        = nullptr;
+  pos_         = 0;
+  first_       = nullptr;
+  first_size_  = 0;
+  second_      = nullptr;
+  second_size_ = 0;
+}
+
+// The magic number is written last, so a ring that opens the segment while
+// it is being created sees it as invalid instead of half-initialized.
+
+struct Ring_::shared_header_
+{
+  std::atomic<std::uint64_t> magic;    // SHARED_MAGIC once initialized
+  std::uint32_t              version;  // SHARED_VERSION
+  std::uint32_t              flags;    // SHARED_SINGLE_PRODUCER/CONSUMER
+  std::uint64_t              capacity; // size of the buffer
+  std::uint64_t              offset;   // offset of the buffer in the segment
+  control_                   control;
+};
+
+Ring_ Ring_::create_shared(const char* name, std::size_t size)
+{
+  return create_shared(name, size, RingOptions());
+}
+
+Ring_ Ring_::create_shared(const char* name, std::size_t size, const RingOptions& options)
+{
+  Ring_ ring;
+  size = round_size(size, options);
+  if (!ring.own_.rptr.is_lock_free() || size == 0)
+    return ring;
+
+  // The buffer starts on a page boundary after the header, which keeps any
+  // alignment up to the page size
+
+  auto offset = round_up(sizeof(shared_header_), page_size());
+  auto segment = create_segment(name, offset + size);
+  if (segment == nullptr)
+    return ring;
+
+  format_(segment, offset, size, options);
+  if (!ring.attach_(segment, offset + size, options.wait))
+  {
+    unmap_segment(segment, offset + size);
+    remove_segment(name);
+    return ring;
+  }
+
+  ring.streaming_ = options.streaming_threshold;
+  if (options.events)
+    ring.create_events_();
+
+  return ring;
+}
+
+Ring_ Ring_::open_shared(const char* name)
+{
+  return open_shared(name, WaitStrategy::spin);
+}
+
+Ring_ Ring_::open_shared(const char* name, WaitStrategy wait)
+{
+  Ring_ ring;
+  std::size_t mapped;
+  auto segment = open_segment(name, mapped);
+  if (segment == nullptr)
+    return ring;
+
+  if (!ring.attach_(segment, mapped, wait))
+    unmap_segment(segment, mapped);
+
+  return ring;
+}
+
+bool Ring_::remove_shared(const char* name)
+{
+  return remove_segment(name);
+}
+
+Ring_ Ring_::open_file(const char* path, std::size_t size)
+{
+  return open_file(path, size, RingOptions());
+}
+
+Ring_ Ring_::open_file(const char* path, std::size_t size, const RingOptions& options)
+{
+  Ring_ ring;
+  size = round_size(size, options);
+  if (!ring.own_.rptr.is_lock_free() || size == 0)
+    return ring;
+
+  auto offset = round_up(sizeof(shared_header_), page_size());
+  std::size_t mapped;
+  bool created;
+  auto segment = open_file_segment(path, offset + size, mapped, created);
+  if (segment == nullptr)
+    return ring;
+
+  if (created)
+    format_(segment, offset, size, options);
+
+  if (!ring.attach_(segment, mapped, options.wait))
+  {
+    unmap_segment(segment, mapped);
+    return ring;
+  }
+
+  if (!created && !ring.recover_())
+    return Ring_();
+
+  ring.streaming_ = options.streaming_threshold;
+  if (options.events)
+    ring.create_events_();
+  ring.flush_ = options.flush;
+  ring.flush_interval_ = options.flush_interval;
+  ring.next_flush_.store((std::chrono::steady_clock::now() + ring.flush_interval_).time_since_epoch().count());
+  if (created)
+    ring.flush();
+
+  return ring;
+}
+
+void Ring_::flush()
+{
+  if (shared_ != nullptr)
+    sync_segment(shared_, mapped_);
+}
+
+void Ring_::format_(char* segment, std::size_t offset, std::size_t size, const RingOptions& options)
+{
+  auto header = ::new(segment) shared_header_();
+  header->version  = SHARED_VERSION;
+  header->flags    = (options.single_producer ? SHARED_SINGLE_PRODUCER : 0)
+                   | (options.single_consumer && !options.overwrite ? SHARED_SINGLE_CONSUMER : 0)
+                   | (options.overwrite ? SHARED_OVERWRITE : 0);
+  header->capacity = size;
+  header->offset   = offset;
+  ::new(&header->control) control_();
+
+  if (options.numa_node >= 0)
+    bind_node(segment, offset + size, options.numa_node);
+  if (options.prefault)
+    prefault(segment, offset + size);
+
+  header->magic.store(SHARED_MAGIC, std::memory_order_release);
+}
+
+bool Ring_::attach_(char* segment, std::size_t mapped, WaitStrategy wait)
+{
+  auto header = reinterpret_cast<shared_header_*>(segment);
+  if (mapped < sizeof(shared_header_) ||
+      header->magic.load(std::memory_order_acquire) != SHARED_MAGIC ||
+      header->version != SHARED_VERSION ||
+      header->offset < sizeof(shared_header_) ||
+      header->capacity == 0 ||
+      header->offset + header->capacity > mapped)
+    return false;
+
+  auto size = static_cast<std::size_t>(header->capacity);
+  beg_ = segment + header->offset;
+  end_ = beg_ + size;
+  mask_ = (size & (size - 1)) == 0 ? size - 1 : NO_MASK;
+  lap_ = 0;
+  mapped_ = mapped;
+  shared_ = segment;
+  ctl_ = &header->control;
+  waiter_.set_strategy(wait == WaitStrategy::block ? WaitStrategy::backoff : wait);
+  single_producer_ = (header->flags & SHARED_SINGLE_PRODUCER) != 0;
+  single_consumer_ = (header->flags & SHARED_SINGLE_CONSUMER) != 0;
+  overwrite_ = (header->flags & SHARED_OVERWRITE) != 0;
+
+  return true;
+}
+
+void Ring_::create_events_()
+{
+  events_ = new event_set_();
+  if (!events_->valid())
+  {
+    delete events_;
+    events_ = nullptr;
+  }
+}
+
+bool Ring_::recover_()
+{
+  // rbuf and wptr only move once a block is released, so they mark what was
+  // completely read and written
+
+  auto rbuf = ctl_->rbuf.load();
+  auto wptr = ctl_->wptr.load();
+  if (wptr < rbuf || wptr - rbuf > capacity())
+    return false;
+
+  ctl_->rptr.store(rbuf);
+  ctl_->rcache.store(wptr);
+  ctl_->wbuf.store(wptr);
+  ctl_->wcache.store(rbuf);
+  for (auto& entry : ctl_->reads)
+    entry.start.store(EMPTY_PENDING);
+  for (auto& entry : ctl_->writes)
+    entry.start.store(EMPTY_PENDING);
+
+  return true;
+}
+
+void Ring_::sync_block_(std::uint64_t pos, std::size_t length)
 {
-  std::atomic_init(&used_, static_cast<std::ptrdiff_t>(0));
-  std::atomic_init(&free_, static_cast<std::ptrdiff_t>(0));
-  std::atomic_init(&rbuf_, static_cast<char*>(0));
-  std::atomic_init(&rptr_, static_cast<char*>(0));
-  std::atomic_init(&wptr_, static_cast<char*>(0));
-  std::atomic_init(&wbuf_, static_cast<char*>(0));
+  auto block = block_(pos);
+  auto tail = static_cast<std::size_t>(end_ - block);
+  if (length <= tail)
+  {
+    sync_segment(block, length);
+  }
+  else
+  {
+    sync_segment(block, tail);
+    sync_segment(beg_, length - tail);
+  }
 }
 
-Ring_::Ring_(std::size_t size)
-  : beg_(new char[size])
-  , end_(beg_ + size)
+void Ring_::sync_commit_()
 {
-  std::atomic_init(&used_, static_cast<std::ptrdiff_t>(0));
-  std::atomic_init(&free_, static_cast<std::ptrdiff_t>(size));
-  std::atomic_init(&rbuf_, beg_);
-  std::atomic_init(&rptr_, beg_);
-  std::atomic_init(&wptr_, beg_);
-  std::atomic_init(&wbuf_, beg_);
+  if (flush_ == FlushPolicy::commit)
+  {
+    sync_segment(shared_, sizeof(shared_header_));
+    return;
+  }
+
+  // Only the thread that moves the next sync time forward syncs the file
+
+  auto now = std::chrono::steady_clock::now().time_since_epoch().count();
+  auto next = next_flush_.load(std::memory_order_relaxed);
+  if (now < next)
+    return;
+
+  auto later = now + std::chrono::duration_cast<std::chrono::steady_clock::duration>(flush_interval_).count();
+  if (next_flush_.compare_exchange_strong(next, later, std::memory_order_relaxed))
+    flush();
 }
 
-Ring_::Ring_(Ring_&& ring)
-  : beg_(ring.beg_)
-  , end_(ring.end_)
+void Ring_::allocate_(std::size_t size, const RingOptions& options)
 {
-  std::atomic_init(&used_, ring.used_.load());
-  std::atomic_init(&free_, ring.free_.load());
-  std::atomic_init(&rbuf_, ring.rbuf_.load());
-  std::atomic_init(&rptr_, ring.rptr_.load());
-  std::atomic_init(&wptr_, ring.wptr_.load());
-  std::atomic_init(&wbuf_, ring.wbuf_.load());
+  mirrored_ = false;
+  mapped_ = 0;
 
-  ring.beg_ = nullptr;
-  ring.end_ = nullptr;
+  if (options.mirrored && size > 0)
+  {
+    auto rounded = round_up(size, mirror_granularity());
+
+    beg_ = map_mirrored(rounded);
+    if (beg_ != nullptr)
+    {
+      end_ = beg_ + rounded;
+      mirrored_ = true;
+    }
+  }
+
+  if (!mirrored_ && size > 0 && (options.alignment > alignof(std::max_align_t) ||
+      options.huge_pages || options.numa_node >= 0 || options.prefault))
+  {
+    beg_ = map_pages(size, options, mapped_);
+    if (beg_ != nullptr)
+      end_ = beg_ + size;
+    else
+      mapped_ = 0;
+  }
+
+  if (!mirrored_ && mapped_ == 0)
+  {
+    beg_ = new char[size];
+    end_ = beg_ + size;
+    return;
+  }
 
-  ring.used_.store(0);
-  ring.free_.store(0);
-  ring.rbuf_.store(nullptr);
-  ring.rptr_.store(nullptr);
-  ring.wptr_.store(nullptr);
-  ring.wbuf_.store(nullptr);
+  if (options.numa_node >= 0)
+    bind_node(beg_, mirrored_ ? capacity() : mapped_, options.numa_node);
+  if (options.prefault)
+    prefault(beg_, capacity());
 }
 
-Ring_& Ring_::operator= (Ring_&& ring)
+void Ring_::deallocate_()
 {
-  delete[] beg_;
+  if (shared_ != nullptr)
+    unmap_segment(shared_, mapped_);
+  else if (mirrored_)
+    unmap_mirrored(beg_, capacity());
+  else if (mapped_ != 0)
+    unmap_pages(beg_, mapped_);
+  else
+    delete[] beg_;
+}
 
-  beg_ = ring.beg_;
-  end_ = ring.end_;
+char* Ring_::normalize_(char* ptr)
+{
+  return ptr < end_ ? ptr : ptr - capacity();
+}
 
-  used_.store(ring.used_.load());
-  free_.store(ring.free_.load());
-  rbuf_.store(ring.rbuf_.load());
-  rptr_.store(ring.rptr_.load());
-  wptr_.store(ring.wptr_.load());
-  wbuf_.store(ring.wbuf_.load());
+char* Ring_::block_(std::uint64_t pos)
+{
+  if (mask_ != NO_MASK)
+    return beg_ + (pos & mask_);
 
-  ring.beg_ = nullptr;
-  ring.end_ = nullptr;
+  return beg_ + detail::wrap(pos, capacity(), lap_);
+}
 
-  ring.used_.store(0);
-  ring.free_.store(0);
-  ring.rbuf_.store(nullptr);
-  ring.rptr_.store(nullptr);
-  ring.wptr_.store(nullptr);
-  ring.wbuf_.store(nullptr);
+std::size_t Ring_::segments_length_(const ReadSegment* segments, std::size_t count)
+{
+  std::size_t length = 0;
+  for (std::size_t i = 0; i < count; ++i)
+    length += segments[i].length;
 
-  return *this;
+  return length;
 }
 
-Ring_::~Ring_()
+std::size_t Ring_::segments_length_(const WriteSegment* segments, std::size_t count)
 {
-  delete[] beg_;
+  std::size_t length = 0;
+  for (std::size_t i = 0; i < count; ++i)
+    length += segments[i].length;
+
+  return length;
 }
 
-std::size_t Ring_::size() const
+template <class Condition>
+bool Ring_::wait_until_(Condition condition, const time_point* deadline, stat_ stall)
 {
-  // The 'used' space can be negative in an over-reserved case, but it can be
-  // clamped to 0 for simplicity.
+  auto i = 0;
+  auto ready = waiter_.wait_until(condition, deadline, i);
+
+  if (i != 0 && stall == STAT_RELEASE_WAITS)
+  {
+    count_(STAT_RELEASE_WAITS, i);
+  }
+  else if (i != 0)
+  {
+    count_(stall, 1);
+    count_(STAT_WAIT_SPINS, i);
+  }
 
-  auto s = used_.load();
-  return s < 0 ? 0 : static_cast<std::size_t>(s);
+  return ready;
 }
 
-std::size_t Ring_::capacity() const
+void Ring_::count_(stat_ stat, std::uint64_t count)
 {
-  return static_cast<std::size_t>(end_ - beg_);
+#ifdef WILT_RING_STATS
+  // Each thread adds to its own stripe of counters so that counting doesn't
+  // add contention between threads
+
+  static std::atomic<unsigned> threads(0);
+  thread_local unsigned stripe = threads.fetch_add(1, std::memory_order_relaxed) % STAT_STRIPES;
+
+  stats_[stripe].counts[stat].fetch_add(count, std::memory_order_relaxed);
+#else
+  (void)stat;
+  (void)count;
+#endif
 }
 
-void Ring_::read(void* data, std::size_t length) noexcept
+void Ring_::count_high_water_(std::uint64_t wptr)
 {
-  auto block = acquire_read_block_(length);
+#ifdef WILT_RING_STATS
+  auto size = wptr - ctl_->rptr.load(std::memory_order_relaxed);
+  auto high = high_water_.load(std::memory_order_relaxed);
+  while (size > high && !high_water_.compare_exchange_weak(high, size, std::memory_order_relaxed))
+    ;
+#else
+  (void)wptr;
+#endif
+}
 
-  copy_read_block_(block, (char*)data, length);
-  release_read_block_(block, length);
+std::ptrdiff_t Ring_::cache_used_(std::uint64_t rptr, std::ptrdiff_t size)
+{
+  // Readers share a copy of wptr on their own cache line, and only load wptr
+  // (written by every commit) when the copy shows too little data. The copy
+  // may go back if readers race to refresh it, which only costs a refresh
+
+  auto wptr = ctl_->rcache.load(std::memory_order_acquire);
+  auto used = static_cast<std::ptrdiff_t>(wptr - rptr);
+  if (used < size)
+  {
+    wptr = ctl_->wptr.load(std::memory_order_acquire);
+    ctl_->rcache.store(wptr, std::memory_order_release);
+    used = static_cast<std::ptrdiff_t>(wptr - rptr);
+  }
+
+  return used;
 }
 
-void Ring_::write(const void* data, std::size_t length) noexcept
+std::ptrdiff_t Ring_::cache_free_(std::uint64_t wbuf, std::ptrdiff_t size)
 {
-  auto block = acquire_write_block_(length);
+  // Writers share a copy of rbuf the same way
 
-  copy_write_block_(block, (const char*)data, length);
-  release_write_block_(block, length);
+  auto capacity = static_cast<std::ptrdiff_t>(this->capacity());
+  auto rbuf = ctl_->wcache.load(std::memory_order_acquire);
+  auto free = capacity - static_cast<std::ptrdiff_t>(wbuf - rbuf);
+  if (free < size)
+  {
+    rbuf = ctl_->rbuf.load(std::memory_order_acquire);
+    ctl_->wcache.store(rbuf, std::memory_order_release);
+    free = capacity - static_cast<std::ptrdiff_t>(wbuf - rbuf);
+  }
+
+  return free;
 }
 
-bool Ring_::try_read(void* data, std::size_t length) noexcept
+std::ptrdiff_t Ring_::make_room_(std::uint64_t wbuf, std::ptrdiff_t size)
 {
-  auto block = try_acquire_read_block_(length);
-  if (block == nullptr)
-    return false;
+  auto free = cache_free_(wbuf, size);
+  if (free < size && overwrite_ && size <= static_cast<std::ptrdiff_t>(capacity()))
+  {
+    drop_(wbuf + size - capacity());
+    free = cache_free_(wbuf, size);
+  }
 
-  copy_read_block_(block, (char*)data, length);
-  release_read_block_(block, length);
+  return free;
+}
 
-  return true;
+void Ring_::drop_(std::uint64_t target)
+{
+  // Dropped data is claimed and released like a read, so the space is only
+  // free once reads in progress before it are released too. Writes still
+  // wait for reads and writes in progress, but never for readers to arrive
+
+  while (true)                                              // loop until dropped
+  {
+    auto old_rptr = ctl_->rptr.load(std::memory_order_relaxed); // read rptr
+    auto size = static_cast<std::ptrdiff_t>(target - old_rptr); // get amount to drop
+    if (size <= 0)
+      return;                                               // dropped enough
+
+    std::uint64_t pos;
+    std::size_t length;
+    if (drop_measure_ != nullptr)                           // drop whole records
+    {
+      if (try_acquire_measured_read_block_(drop_header_, drop_measure_, length, pos) == nullptr)
+        return;                                             // oldest not committed
+    }
+    else
+    {
+      auto used = cache_used_(old_rptr, size);              // check for data
+      if (used <= 0)
+        return;                                             // oldest not committed
+
+      if (used < size)
+        size = used;
+      if (!ctl_->rptr.compare_exchange_strong(old_rptr, old_rptr + size)) // try commit
+      {
+        count_(STAT_READ_RETRIES);                          // count conflict
+        continue;
+      }
+
+      length = static_cast<std::size_t>(size);
+      pos = old_rptr;
+    }
+
+    release_read_block_(pos, length);                       // release unread
+    ctl_->dropped.fetch_add(length, std::memory_order_relaxed);
+  }
 }
 
-bool Ring_::try_write(const void* data, std::size_t length) noexcept
+void Ring_::drop_records_(std::size_t header, std::size_t (*measure)(const char*))
 {
-  auto block = try_acquire_write_block_(length);
-  if (block == nullptr)
-    return false;
+  drop_header_ = header;
+  drop_measure_ = measure;
+}
 
-  copy_write_block_(block, (const char*)data, length);
-  release_write_block_(block, length);
+void Ring_::notify_()
+{
+  // Commits store their position and waiters are pushed with sequentially
+  // consistent operations, so either this sees the waiter or the waiter's
+  // check sees the commit
 
-  return true;
+  if (async_waiters_.load() != nullptr)
+    wake_async_();
+
+  waiter_.notify();
 }
 
-char* Ring_::normalize_(char* ptr)
+void Ring_::signal_event_(bool read)
 {
-  return ptr < end_ ? ptr : ptr - capacity();
+  // Like notify_, the commit's store and the flag's load are sequentially
+  // consistent, so either this sees the flag cleared or the reads or writes
+  // after clearing it see the commit
+
+  auto& event = read ? events_->read : events_->write;
+  if (event.signaled.load() || event.signaled.exchange(true))
+    return;                                                 // already signaled
+
+  signal_event(event.signal);
+}
+
+void Ring_::park_async_(async_waiter_* waiter)
+{
+  // Once pushed, the waiter belongs to whichever thread takes the stack and
+  // may already be resumed and freed, so what the check needs is copied first
+
+  auto write = waiter->write;
+  auto length = waiter->length;
+
+  auto next = async_waiters_.load(std::memory_order_relaxed);
+  do
+  {
+    waiter->next = next;
+  } while (!async_waiters_.compare_exchange_weak(next, waiter));
+
+  if (write ? writable_(length) : readable_(length))        // check for commits
+    wake_async_();                                          // since it failed
+}
+
+void Ring_::wake_async_()
+{
+  // Waiters that fail again are parked like new ones, and if that finds the
+  // ring changed the stack is taken again
+
+  for (auto waiter = async_waiters_.exchange(nullptr); waiter != nullptr; )
+  {
+    auto next = waiter->next;
+    if (!waiter->attempt(waiter))                           // try again
+      park_async_(waiter);                                  // or park again
+    waiter = next;
+  }
+}
+
+bool Ring_::readable_(std::size_t length) const
+{
+  return size() >= length;
+}
+
+bool Ring_::writable_(std::size_t length) const
+{
+  auto rbuf = ctl_->rbuf.load();
+  auto wbuf = ctl_->wbuf.load();
+  return capacity() - static_cast<std::size_t>(wbuf - rbuf) >= length || (overwrite_ && size() > 0);
+}
+
+std::uint64_t Ring_::publish_(atom_pos& front, pending_* pending, std::uint64_t pos, std::uint64_t end)
+{
+  // Only the thread that released a block may move 'front' past it, until it
+  // leaves it in the table, then only the thread that takes it back out.
+  // Leaving a block stores the entry then checks 'front', and moving 'front'
+  // stores it then checks the entry, so at least one side sees the other and
+  // taking the entry decides which of them moves on. Positions never repeat,
+  // so an entry holding a position can't have been refilled.
+
+  while (front.load() != pos)                               // check for earlier blocks
+  {
+    auto& entry = pending[hash_position(pos, PENDING_BITS)];
+    auto start = EMPTY_PENDING;
+    if (entry.start.compare_exchange_strong(start, BUSY_PENDING)) // take entry
+    {
+      entry.end.store(end, std::memory_order_relaxed);
+      entry.start.store(pos);                               // leave block
+      if (front.load() != pos)                              // check for earlier blocks
+        return pos;                                         // left for them
+
+      start = pos;
+      if (!entry.start.compare_exchange_strong(start, EMPTY_PENDING)) // take block back
+        return pos;                                         // they took it
+      break;
+    }
+
+    wait_until_([&]{                                        // wait for entry
+      return front.load() == pos                            // or earlier blocks
+          || entry.start.load() == EMPTY_PENDING;
+    }, nullptr, STAT_RELEASE_WAITS);
+  }
+
+  // Runs of blocks waiting in the table are taken before 'front' is stored,
+  // so it only has to move once for all of them
+
+  for (auto stored = false; ; )                             // loop while blocks pending
+  {
+    auto& entry = pending[hash_position(end, PENDING_BITS)];
+    auto start = end;
+    if (entry.start.load() == end)                          // check for next block
+    {
+      auto next = entry.end.load(std::memory_order_relaxed);
+      if (entry.start.compare_exchange_strong(start, EMPTY_PENDING)) // take block
+      {
+        end = next;
+        stored = false;
+        continue;
+      }
+    }
+
+    if (stored)                                             // no block after 'front'
+      return end;
+
+    front.store(end);                                       // finish commit
+    stored = true;                                          // check again after
+  }
 }
 
-char* Ring_::acquire_read_block_(std::size_t length)
+char* Ring_::acquire_read_block_(std::size_t length, std::uint64_t& pos, const time_point* deadline)
 {
   auto size = static_cast<std::ptrdiff_t>(length);
+  if (single_consumer_)                                     // no other readers
+  {
+    auto old_rptr = ctl_->rptr.load(std::memory_order_relaxed); // read rptr
+    if (!wait_until_([&]{                                   // check for data
+      return cache_used_(old_rptr, size) >= size;           // wait until success
+    }, deadline, STAT_EMPTY_STALLS))
+      return nullptr;                                       // return timeout
+
+    ctl_->rptr.store(old_rptr + size, std::memory_order_relaxed); // commit
+    pos = old_rptr;
+    return block_(old_rptr);                                // committed
+  }
+
   while (true)                                              // loop while conflict
   {
-    auto old_rptr = rptr_.load(std::memory_order_consume);  // read rptr
-    while (used_.load(std::memory_order_consume) < size)    // check for data
-      ;                                                     // spin until success
+    auto old_rptr = ctl_->rptr.load(std::memory_order_relaxed); // read rptr
+    if (!wait_until_([&]{                                   // check for data
+      return cache_used_(old_rptr, size) >= size;           // wait until success
+    }, deadline, STAT_EMPTY_STALLS))
+      return nullptr;                                       // return timeout
 
-    auto new_rptr = normalize_(old_rptr + size);            // get block end
-    used_.fetch_sub(size);                                  // reserve
-    if (rptr_.compare_exchange_strong(old_rptr, new_rptr))  // try commit
-      return old_rptr;                                      // committed
+    auto new_rptr = old_rptr + size;                        // get block end
+    if (ctl_->rptr.compare_exchange_strong(old_rptr, new_rptr)) // try commit
+    {
+      pos = old_rptr;
+      return block_(old_rptr);                              // committed
+    }
 
-    used_.fetch_add(size, std::memory_order_relaxed);       // un-reserve
+    count_(STAT_READ_RETRIES);                              // count conflict
   }
 }
 
-char* Ring_::try_acquire_read_block_(std::size_t length)
+char* Ring_::try_acquire_read_block_(std::size_t length, std::uint64_t& pos)
 {
   auto size = static_cast<std::ptrdiff_t>(length);
+  if (single_consumer_)                                     // no other readers
+  {
+    auto old_rptr = ctl_->rptr.load(std::memory_order_relaxed); // read rptr
+    if (cache_used_(old_rptr, size) < size)                 // check for data
+      return nullptr;                                       // return failure
+
+    ctl_->rptr.store(old_rptr + size, std::memory_order_relaxed); // commit
+    pos = old_rptr;
+    return block_(old_rptr);                                // committed
+  }
+
+  while (true)                                              // loop while conflict
+  {
+    auto old_rptr = ctl_->rptr.load(std::memory_order_relaxed); // read rptr
+    if (cache_used_(old_rptr, size) < size)                 // check for data
+      return nullptr;                                       // return failure
+
+    auto new_rptr = old_rptr + size;                        // get block end
+    if (ctl_->rptr.compare_exchange_strong(old_rptr, new_rptr)) // try commit
+    {
+      pos = old_rptr;
+      return block_(old_rptr);                              // committed
+    }
+
+    count_(STAT_READ_RETRIES);                              // count conflict
+  }
+}
+
+char* Ring_::acquire_some_read_block_(std::size_t& length, std::size_t unit, std::uint64_t& pos)
+{
+  auto min = static_cast<std::ptrdiff_t>(unit);
+  auto max = static_cast<std::ptrdiff_t>(length - length % unit);
+  if (single_consumer_)                                     // no other readers
+  {
+    auto old_rptr = ctl_->rptr.load(std::memory_order_relaxed); // read rptr
+    auto used = std::ptrdiff_t(0);
+    wait_until_([&]{                                        // check for data
+      return (used = cache_used_(old_rptr, max)) >= min;    // wait until success
+    }, nullptr, STAT_EMPTY_STALLS);
+
+    auto size = used < max ? used - used % min : max;       // get block size
+    ctl_->rptr.store(old_rptr + size, std::memory_order_relaxed); // commit
+    length = static_cast<std::size_t>(size);
+    pos = old_rptr;
+    return block_(old_rptr);                                // committed
+  }
+
+  while (true)                                              // loop while conflict
+  {
+    auto old_rptr = ctl_->rptr.load(std::memory_order_relaxed); // read rptr
+    auto used = std::ptrdiff_t(0);
+    wait_until_([&]{                                        // check for data
+      return (used = cache_used_(old_rptr, max)) >= min;    // wait until success
+    }, nullptr, STAT_EMPTY_STALLS);
+
+    auto size = used < max ? used - used % min : max;       // get block size
+    auto new_rptr = old_rptr + size;                        // get block end
+    if (ctl_->rptr.compare_exchange_strong(old_rptr, new_rptr)) // try commit
+    {
+      length = static_cast<std::size_t>(size);
+      pos = old_rptr;
+      return block_(old_rptr);                              // committed
+    }
+
+    count_(STAT_READ_RETRIES);                              // count conflict
+  }
+}
+
+char* Ring_::try_acquire_some_read_block_(std::size_t& length, std::size_t unit, std::uint64_t& pos)
+{
+  auto min = static_cast<std::ptrdiff_t>(unit);
+  auto max = static_cast<std::ptrdiff_t>(length - length % unit);
+  if (single_consumer_)                                     // no other readers
+  {
+    auto old_rptr = ctl_->rptr.load(std::memory_order_relaxed); // read rptr
+    auto used = cache_used_(old_rptr, max);                 // check for data
+    if (used < min || max == 0)
+      return nullptr;                                       // return failure
+
+    auto size = used < max ? used - used % min : max;       // get block size
+    ctl_->rptr.store(old_rptr + size, std::memory_order_relaxed); // commit
+    length = static_cast<std::size_t>(size);
+    pos = old_rptr;
+    return block_(old_rptr);                                // committed
+  }
+
   while (true)                                              // loop while conflict
   {
-    auto old_rptr = rptr_.load(std::memory_order_consume);  // read rptr
-    if (used_.load(std::memory_order_consume) < size)       // check for data
+    auto old_rptr = ctl_->rptr.load(std::memory_order_relaxed); // read rptr
+    auto used = cache_used_(old_rptr, max);                 // check for data
+    if (used < min || max == 0)
       return nullptr;                                       // return failure
 
-    auto new_rptr = normalize_(old_rptr + size);            // get block end
-    used_.fetch_sub(size);                                  // reserve
-    if (rptr_.compare_exchange_strong(old_rptr, new_rptr))  // try commit
-      return old_rptr;                                      // committed
+    auto size = used < max ? used - used % min : max;       // get block size
+    auto new_rptr = old_rptr + size;                        // get block end
+    if (ctl_->rptr.compare_exchange_strong(old_rptr, new_rptr)) // try commit
+    {
+      length = static_cast<std::size_t>(size);
+      pos = old_rptr;
+      return block_(old_rptr);                              // committed
+    }
 
-    used_.fetch_add(size, std::memory_order_relaxed);       // un-reserve
+    count_(STAT_READ_RETRIES);                              // count conflict
   }
 }
 
 void Ring_::copy_read_block_(const char* block, char* data, std::size_t length)
 {
-  if (block + length < end_)
+  if (mirrored_ || block + length < end_)
   {
     std::memcpy(data, block, length);
   }
@@ -219,55 +2438,312 @@ void Ring_::copy_read_block_(const char* block, char* data, std::size_t length)
   }
 }
 
-void Ring_::release_read_block_(char* old_rptr, std::size_t length)
+void Ring_::scatter_read_block_(const char* block, const ReadSegment* segments, std::size_t count)
+{
+  // Each segment is copied like a read of its own, the block pointer wraps
+  // once it passes the end of the array
+
+  for (std::size_t i = 0; i < count; ++i)
+  {
+    copy_read_block_(block, (char*)segments[i].data, segments[i].length);
+    block = normalize_(const_cast<char*>(block) + segments[i].length);
+  }
+}
+
+const char* Ring_::peek_block_(std::size_t length, std::uint64_t& pos, const time_point* deadline)
+{
+  auto size = static_cast<std::ptrdiff_t>(length);
+  auto old_rptr = std::uint64_t(0);
+  if (!wait_until_([&]{                                     // check for data
+    old_rptr = ctl_->rptr.load(std::memory_order_relaxed);  // at the front
+    return cache_used_(old_rptr, size) >= size;             // wait until success
+  }, deadline, STAT_EMPTY_STALLS))
+    return nullptr;                                         // return timeout
+
+  pos = old_rptr;
+  return block_(old_rptr);                                  // not claimed
+}
+
+const char* Ring_::try_peek_block_(std::size_t length, std::uint64_t& pos)
+{
+  return peek_block_(length, pos, &IMMEDIATELY);
+}
+
+bool Ring_::peek_valid_(std::uint64_t pos) const
+{
+  // Data can only be overwritten once it's been claimed and released, so if
+  // rptr hasn't moved the copy is whole. The fence keeps the copy's loads
+  // before the check, like the read side of a seqlock
+
+  std::atomic_thread_fence(std::memory_order_acquire);
+  return ctl_->rptr.load(std::memory_order_relaxed) == pos;
+}
+
+void Ring_::shrink_read_block_(std::uint64_t pos, std::size_t used)
+{
+  ctl_->rptr.store(pos + used, std::memory_order_relaxed);  // no other readers
+}
+
+char* Ring_::acquire_measured_read_block_(std::size_t header, std::size_t (*measure)(const char*), std::size_t& length, std::uint64_t& pos, const time_point* deadline)
+{
+  char head[MAX_HEADER];
+  auto hsize = static_cast<std::ptrdiff_t>(header);
+  if (single_consumer_)                                     // no other readers
+  {
+    auto old_rptr = ctl_->rptr.load(std::memory_order_relaxed); // read rptr
+    if (!wait_until_([&]{                                   // check for header
+      return cache_used_(old_rptr, hsize) >= hsize;         // wait until success
+    }, deadline, STAT_EMPTY_STALLS))
+      return nullptr;                                       // return timeout
+
+    copy_read_block_(block_(old_rptr), head, header);       // read header
+    auto size = static_cast<std::ptrdiff_t>(measure(head)); // get block size
+    if (!wait_until_([&]{                                   // check for data
+      return cache_used_(old_rptr, size) >= size;           // wait until success
+    }, deadline, STAT_EMPTY_STALLS))
+      return nullptr;                                       // return timeout
+
+    ctl_->rptr.store(old_rptr + size, std::memory_order_relaxed); // commit
+    length = static_cast<std::size_t>(size);
+    pos = old_rptr;
+    return block_(old_rptr);                                // committed
+  }
+
+  while (true)                                              // loop while conflict
+  {
+    auto old_rptr = ctl_->rptr.load(std::memory_order_relaxed); // read rptr
+    if (!wait_until_([&]{                                   // check for header
+      return cache_used_(old_rptr, hsize) >= hsize;         // wait until success
+    }, deadline, STAT_EMPTY_STALLS))
+      return nullptr;                                       // return timeout
+
+    // The header is read before the block is claimed, which is only valid if
+    // no other reader claimed it in the meantime. Positions never repeat, so
+    // an unchanged read position means the header was not released. It's
+    // checked like a peek, with the copy fenced before the check
+
+    copy_read_block_(block_(old_rptr), head, header);       // read header
+    if (!peek_valid_(old_rptr))                             // check for other reads
+      continue;                                             // header may be stale
+
+    auto size = static_cast<std::ptrdiff_t>(measure(head)); // get block size
+    if (!wait_until_([&]{                                   // check for data
+      return cache_used_(old_rptr, size) >= size            // wait until success
+          || ctl_->rptr.load(std::memory_order_relaxed) != old_rptr;
+    }, deadline, STAT_EMPTY_STALLS))
+      return nullptr;                                       // return timeout
+    if (ctl_->rptr.load(std::memory_order_relaxed) != old_rptr) // check for other reads
+      continue;                                             // block was claimed
+
+    auto new_rptr = old_rptr + size;                        // get block end
+    if (ctl_->rptr.compare_exchange_strong(old_rptr, new_rptr)) // try commit
+    {
+      length = static_cast<std::size_t>(size);
+      pos = old_rptr;
+      return block_(old_rptr);                              // committed
+    }
+
+    count_(STAT_READ_RETRIES);                              // count conflict
+  }
+}
+
+char* Ring_::try_acquire_measured_read_block_(std::size_t header, std::size_t (*measure)(const char*), std::size_t& length, std::uint64_t& pos)
+{
+  return acquire_measured_read_block_(header, measure, length, pos, &IMMEDIATELY);
+}
+
+void Ring_::release_read_block_(std::uint64_t old_rptr, std::size_t length)
 {
-  auto new_rptr = normalize_(old_rptr + length);            // get block end
-  while (rbuf_.load() != old_rptr)                          // check for earlier reads
-    ;                                                       // spin until reads complete
+  auto new_rptr = old_rptr + length;                        // get block end
+  if (single_consumer_)                                     // no earlier reads
+    ctl_->rbuf.store(new_rptr);                             // finish commit
+  else if (publish_(ctl_->rbuf, ctl_->reads, old_rptr, new_rptr) == old_rptr)
+    return;                                                 // left for earlier reads
 
-  rbuf_.store(new_rptr);                                    // finish commit
-  free_.fetch_add(length, std::memory_order_relaxed);       // add to free space
+  if (events_ != nullptr)                                   // signal pollers
+    signal_event_(false);
+  notify_();                                                // wake parked threads
 }
 
-char* Ring_::acquire_write_block_(std::size_t length)
+char* Ring_::acquire_write_block_(std::size_t length, std::uint64_t& pos, const time_point* deadline)
 {
   auto size = static_cast<std::ptrdiff_t>(length);
+  if (single_producer_)                                     // no other writers
+  {
+    auto old_wbuf = ctl_->wbuf.load(std::memory_order_relaxed); // read wbuf
+    if (!wait_until_([&]{                                   // check for space
+      return make_room_(old_wbuf, size) >= size;            // wait until success
+    }, deadline, STAT_FULL_STALLS))
+      return nullptr;                                       // return timeout
+
+    ctl_->wbuf.store(old_wbuf + size, std::memory_order_relaxed); // commit
+    pos = old_wbuf;
+    return block_(old_wbuf);                                // committed
+  }
+
   while (true)                                              // loop while conflict
   {
-    auto old_wbuf = wbuf_.load(std::memory_order_consume);  // read wbuf
-    while (free_.load(std::memory_order_consume) < size)    // check for space
-      ;                                                     // spin until success
+    auto old_wbuf = ctl_->wbuf.load(std::memory_order_relaxed); // read wbuf
+    if (!wait_until_([&]{                                   // check for space
+      return make_room_(old_wbuf, size) >= size;            // wait until success
+    }, deadline, STAT_FULL_STALLS))
+      return nullptr;                                       // return timeout
 
-    auto new_wbuf = normalize_(old_wbuf + size);            // get block end
-    free_.fetch_sub(size);                                  // reserve
-    if (wbuf_.compare_exchange_strong(old_wbuf, new_wbuf))  // try commit
-      return old_wbuf;                                      // committed
+    auto new_wbuf = old_wbuf + size;                        // get block end
+    if (ctl_->wbuf.compare_exchange_strong(old_wbuf, new_wbuf)) // try commit
+    {
+      pos = old_wbuf;
+      return block_(old_wbuf);                              // committed
+    }
 
-    free_.fetch_add(size, std::memory_order_relaxed);       // un-reserve
+    count_(STAT_WRITE_RETRIES);                             // count conflict
   }
 }
 
-char* Ring_::try_acquire_write_block_(std::size_t length)
+char* Ring_::try_acquire_write_block_(std::size_t length, std::uint64_t& pos)
 {
   auto size = static_cast<std::ptrdiff_t>(length);
+  if (single_producer_)                                     // no other writers
+  {
+    auto old_wbuf = ctl_->wbuf.load(std::memory_order_relaxed); // read wbuf
+    if (make_room_(old_wbuf, size) < size)                  // check for space
+      return nullptr;                                       // return failure
+
+    ctl_->wbuf.store(old_wbuf + size, std::memory_order_relaxed); // commit
+    pos = old_wbuf;
+    return block_(old_wbuf);                                // committed
+  }
+
   while (true)                                              // loop while conflict
   {
-    auto old_wbuf = wbuf_.load(std::memory_order_consume);  // read wbuf
-    if (free_.load(std::memory_order_consume) < size)       // check for space
+    auto old_wbuf = ctl_->wbuf.load(std::memory_order_relaxed); // read wbuf
+    if (make_room_(old_wbuf, size) < size)                  // check for space
       return nullptr;                                       // return failure
 
-    auto new_wbuf = normalize_(old_wbuf + size);            // get block end
-    free_.fetch_sub(size);                                  // reserve
-    if (wbuf_.compare_exchange_strong(old_wbuf, new_wbuf))  // try commit
-      return old_wbuf;                                      // committed
+    auto new_wbuf = old_wbuf + size;                        // get block end
+    if (ctl_->wbuf.compare_exchange_strong(old_wbuf, new_wbuf)) // try commit
+    {
+      pos = old_wbuf;
+      return block_(old_wbuf);                              // committed
+    }
+
+    count_(STAT_WRITE_RETRIES);                             // count conflict
+  }
+}
+
+char* Ring_::acquire_some_write_block_(std::size_t& length, std::uint64_t& pos)
+{
+  auto max = static_cast<std::ptrdiff_t>(length < capacity() ? length : capacity());
+  if (single_producer_)                                     // no other writers
+  {
+    auto old_wbuf = ctl_->wbuf.load(std::memory_order_relaxed); // read wbuf
+    auto free = std::ptrdiff_t(0);
+    wait_until_([&]{                                        // check for space
+      return (free = make_room_(old_wbuf, max)) > 0;        // wait until success
+    }, nullptr, STAT_FULL_STALLS);
+
+    auto size = free < max ? free : max;                    // get block size
+    ctl_->wbuf.store(old_wbuf + size, std::memory_order_relaxed); // commit
+    length = static_cast<std::size_t>(size);
+    pos = old_wbuf;
+    return block_(old_wbuf);                                // committed
+  }
+
+  while (true)                                              // loop while conflict
+  {
+    auto old_wbuf = ctl_->wbuf.load(std::memory_order_relaxed); // read wbuf
+    auto free = std::ptrdiff_t(0);
+    wait_until_([&]{                                        // check for space
+      return (free = make_room_(old_wbuf, max)) > 0;        // wait until success
+    }, nullptr, STAT_FULL_STALLS);
+
+    auto size = free < max ? free : max;                    // get block size
+    auto new_wbuf = old_wbuf + size;                        // get block end
+    if (ctl_->wbuf.compare_exchange_strong(old_wbuf, new_wbuf)) // try commit
+    {
+      length = static_cast<std::size_t>(size);
+      pos = old_wbuf;
+      return block_(old_wbuf);                              // committed
+    }
+
+    count_(STAT_WRITE_RETRIES);                             // count conflict
+  }
+}
+
+void Ring_::shrink_write_block_(std::uint64_t pos, std::size_t used)
+{
+  ctl_->wbuf.store(pos + used, std::memory_order_relaxed);  // no other writers
+}
+
+char* Ring_::acquire_padded_write_block_(std::size_t length, std::size_t& padding, std::size_t& total, std::uint64_t& pos, const time_point* deadline)
+{
+  auto capacity = this->capacity();
+  auto pad = [&](std::uint64_t old_wbuf) -> std::size_t {   // get padding
+    auto index = static_cast<std::size_t>(block_(old_wbuf) - beg_);
+    return !mirrored_ && index + length > capacity ? capacity - index : 0;
+  };
+
+  if (single_producer_)                                     // no other writers
+  {
+    auto old_wbuf = ctl_->wbuf.load(std::memory_order_relaxed); // read wbuf
+    auto padded = pad(old_wbuf);                            // get padding
+    auto size = static_cast<std::ptrdiff_t>(padded + length <= capacity ? padded + length : padded);
+    if (!wait_until_([&]{                                   // check for space
+      return make_room_(old_wbuf, size) >= size;            // wait until success
+    }, deadline, STAT_FULL_STALLS))
+      return nullptr;                                       // return timeout
+
+    ctl_->wbuf.store(old_wbuf + size, std::memory_order_relaxed); // commit
+    padding = padded;
+    total = static_cast<std::size_t>(size);
+    pos = old_wbuf;
+    return block_(old_wbuf);                                // committed
+  }
+
+  while (true)                                              // loop while conflict
+  {
+    auto old_wbuf = ctl_->wbuf.load(std::memory_order_relaxed); // read wbuf
+    auto padded = pad(old_wbuf);                            // get padding
+    auto size = static_cast<std::ptrdiff_t>(padded + length <= capacity ? padded + length : padded);
+    if (!wait_until_([&]{                                   // check for space
+      return make_room_(old_wbuf, size) >= size;            // wait until success
+    }, deadline, STAT_FULL_STALLS))
+      return nullptr;                                       // return timeout
 
-    free_.fetch_add(size, std::memory_order_relaxed);       // un-reserve
+    auto new_wbuf = old_wbuf + size;                        // get block end
+    if (ctl_->wbuf.compare_exchange_strong(old_wbuf, new_wbuf)) // try commit
+    {
+      padding = padded;
+      total = static_cast<std::size_t>(size);
+      pos = old_wbuf;
+      return block_(old_wbuf);                              // committed
+    }
+
+    count_(STAT_WRITE_RETRIES);                             // count conflict
   }
 }
 
+char* Ring_::try_acquire_padded_write_block_(std::size_t length, std::size_t& padding, std::size_t& total, std::uint64_t& pos)
+{
+  return acquire_padded_write_block_(length, padding, total, pos, &IMMEDIATELY);
+}
+
 void Ring_::copy_write_block_(char* block, const char* data, std::size_t length)
 {
-  if (block + length < end_)
+  if (streaming_ != 0 && length >= streaming_)
+  {
+    if (mirrored_ || block + length < end_)
+    {
+      stream_copy(block, data, length);
+    }
+    else
+    {
+      auto first = end_ - block;
+      stream_copy(block, data, first);
+      stream_copy(beg_, data + first, length - first);
+    }
+  }
+  else if (mirrored_ || block + length < end_)
   {
     std::memcpy(block, data, length);
   }
@@ -279,12 +2755,30 @@ void Ring_::copy_write_block_(char* block, const char* data, std::size_t length)
   }
 }
 
-void Ring_::release_write_block_(char* old_wbuf, std::size_t length)
+void Ring_::gather_write_block_(char* block, const WriteSegment* segments, std::size_t count)
+{
+  for (std::size_t i = 0; i < count; ++i)
+  {
+    copy_write_block_(block, (const char*)segments[i].data, segments[i].length);
+    block = normalize_(block + segments[i].length);
+  }
+}
+
+void Ring_::release_write_block_(std::uint64_t old_wbuf, std::size_t length)
 {
-  auto new_wbuf = normalize_(old_wbuf + length);            // get block end
-  while (wptr_.load() != old_wbuf)                          // wait for earlier writes
-    ;                                                       // spin until writes complete
+  auto new_wbuf = old_wbuf + length;                        // get block end
+  if (flush_ == FlushPolicy::commit)                        // make data durable
+    sync_block_(old_wbuf, length);                          // before committing
+
+  if (single_producer_)                                     // no earlier writes
+    ctl_->wptr.store(new_wbuf);                             // finish commit
+  else if ((new_wbuf = publish_(ctl_->wptr, ctl_->writes, old_wbuf, new_wbuf)) == old_wbuf)
+    return;                                                 // left for earlier writes
 
-  wptr_.store(new_wbuf);                                    // finish commit
-  used_.fetch_add(length, std::memory_order_relaxed);       // add to used space
+  count_high_water_(new_wbuf);                              // track most data
+  if (flush_ != FlushPolicy::none)                          // sync for policy
+    sync_commit_();
+  if (events_ != nullptr)                                   // signal pollers
+    signal_event_(true);
+  notify_();                                                // wake parked threads
 }
@@ -30,19 +30,67 @@
 
 #include <atomic>
 // - std::atomic
+#include <chrono>
+// - std::chrono::duration
+// - std::chrono::steady_clock
+#include <condition_variable>
+// - std::condition_variable
 #include <cstddef>
 // - std::size_t
 // - std::ptrdiff_t
+#include <cstdint>
+// - std::int64_t
+// - std::uint64_t
+#include <cstring>
+// - std::memcpy
+#include <iterator>
+// - std::distance
+#include <mutex>
+// - std::mutex
 #include <new>
 // - ::new(ptr)
+#include <thread>
+// - std::this_thread::yield
 #include <type_traits>
+// - std::is_nothrow_constructible
+// - std::is_nothrow_copy_assignable
 // - std::is_nothrow_copy_constructible
 // - std::is_nothrow_move_constructible
 // - std::is_nothrow_move_assignable
 // - std::is_nothrow_destructible
+// - std::conditional
+// - std::integral_constant
+// - std::is_pointer
+// - std::is_same
+// - std::is_trivially_copyable
+// - std::is_trivially_destructible
+// - std::remove_cv
+// - std::remove_pointer
 #include <utility>
+// - std::declval
+// - std::forward
 // - std::move
 
+#include "histogram.h"
+// - wilt::LatencyHistogram
+
+// Ring<T> has coroutine awaitables when the compiler supports C++20
+// coroutines, defining WILT_RING_COROUTINES as 0 leaves them out
+#ifndef WILT_RING_COROUTINES
+#if defined(__cpp_impl_coroutine) && defined(__has_include)
+#if __has_include(<coroutine>)
+#define WILT_RING_COROUTINES 1
+#endif
+#endif
+#endif
+
+#if WILT_RING_COROUTINES
+#include <coroutine>
+// - std::coroutine_handle
+#include <optional>
+// - std::optional
+#endif
+
 namespace wilt
 {
   //////////////////////////////////////////////////////////////////////////////
@@ -50,82 +98,549 @@ namespace wilt
   // concurrent readers and writers in a lock-free manner.
   // 
   // The class works by allocating the array and storing two pointers (for the
-  // beginning and end of the allocated space). Two atomic pointers are used to
+  // beginning and end of the allocated space). Two atomic positions are used to
   // track the beginning and end of the currently used storage space. To
-  // facilitate concurrent reads and writes, theres a read buffer pointer before
-  // the read pointer for data currently being read, and a corresponding write
-  // buffer pointer beyond the write pointer for data currently being written.
-  // These buffer pointers cannot overlap. Just using these pointers suffer from
-  // some minute inefficiencies and a few ABA problems. Therfore, atomic
-  // integers are used to store the currently used and currently free sizes.
+  // facilitate concurrent reads and writes, theres a read buffer position
+  // before the read position for data currently being read, and a corresponding
+  // write buffer position beyond the write position for data currently being
+  // written. These buffer positions cannot overlap. Positions are 64-bit byte
+  // counts that only ever increase, so they never repeat (no ABA problems) and
+  // the amount of data is simply the difference between two of them. They are
+  // wrapped into the array when accessing it, with a mask if the capacity is a
+  // power of two. Since the positions owned by the other side are written by
+  // every commit, each side keeps its own copy of the other side's position
+  // in a cache line it already uses, and only loads the real position when
+  // the copy shows too little data or space. The copies lag behind, so they
+  // never show more than there is.
   // 
   // It allows multiple readers and multiple writers by implementing a reserve-
-  // commit system. A thread wanting to read will check the used size to see if
-  // there's enough data. If there is, it subtracts from the used size to
-  // 'reserve' the read. It then does a compare-exchange to 'commit' by
-  // increasing the read pointer. If that fails, then it backs out ('un-
-  // reserves') by adding back to the used size and tries again. If it
-  // succeeds, then it proceeds to read the data. In order to complete, the
-  // reader must update the read buffer pointer to where it just finished
-  // reading from. However, because other readers that started before may not be
-  // done yet, the reader must wait until the read buffer pointer points to
-  // where the read started. Only, then is the read buffer pointer updated, and
-  // the free size increased. So while this implementation is lock-free, it is
-  // not wait-free. This same principle works the same when writing (ammended
-  // for the appropriate pointers).
+  // commit system. A thread wanting to read will check the data between the
+  // read position and its copy of the write position to see if there's enough
+  // data. If there is, it does a compare-exchange to 'commit' by increasing
+  // the read position. If that fails, another reader took the data first and
+  // it tries again. If it succeeds, then it proceeds to read the data. In
+  // order to complete, the read buffer position must be moved past the block.
+  // However, because other readers that started before may not be done yet,
+  // it can only move once the read buffer position points to where the read
+  // started. A reader that finishes early leaves its block in a small table
+  // of pending blocks and returns, and the reader that moves the read buffer
+  // position up to that block takes it from the table and moves past it too,
+  // publishing the whole run at once. Only if the block's entry in the table
+  // is taken by another pending block does the reader wait for its turn, so
+  // while this implementation is lock-free, it is not wait-free. This same
+  // principle works the same when writing (ammended for the appropriate
+  // positions).
   // 
   // If two readers try to read at the same time and there is only enough data
-  // for one of them. The used size MAY be negative because they both 'reserve'
-  // the data. This is an over-reserved state. But the compare-exchange will
-  // only allow one reader to 'commit' to the read and the other will 'un-
-  // reserve' the read.
+  // for one of them, the compare-exchange will only allow one reader to
+  // 'commit' to the read and the other will see that there's no data left.
+  // 
+  // With RingOptions::overwrite, a write that doesn't fit first claims the
+  // oldest data the same way and releases it unread. It then only waits for
+  // reads in progress to release their blocks, never for a reader to come
+  // along and make room.
   // 
-  // |beg           |rptr      used=5             |wbuf         - unused
+  // |beg           |rptr                         |wbuf         - unused
   // |----|----|++++|====|====|====|====|====|++++|----|        + modifying
-  //  free=3   |rbuf                         |wptr     |end     = used
+  //           |rbuf                         |wptr     |end     = used
   // 
   // The diagram above shows a buffer of size 10 storing 5 bytes with a reader
   // reading one byte and one writer reading one byte.
   // 
   // Out of the box, the class works by reading and writing raw bytes from POD
-  // data types and arrays. A wrapper could allow for a nicer interface for
-  // pushing and popping elements. As it stands, this structure cannot be easily
-  // modified to store types of variable size.
+  // data types and arrays. The Ring<T> wrapper allows for a nicer interface for
+  // pushing and popping elements. This structure doesn't track the size of
+  // each write, so types of variable size are stored with MessageRing (see
+  // message_ring.h), which frames each message with a header.
+
+  //////////////////////////////////////////////////////////////////////////////
+  // Determines how blocking operations wait, be it for data, for space, or for
+  // earlier operations to complete.
+  //
+  //   spin    - busy waits, pausing the cpu between checks
+  //   backoff - busy waits for a short while, then yields the thread between
+  //             checks
+  //   block   - spins and yields for a short while, then parks the thread
+  //             until a commit wakes it up. Idle threads cost nothing, but
+  //             every commit must check for parked threads
+
+  enum class WaitStrategy
+  {
+    spin,
+    backoff,
+    block
+  };
+
+  namespace detail
+  {
+    ////////////////////////////////////////////////////////////////////////////
+    // Waits for conditions according to a WaitStrategy, for every ring type.
+    // Threads spin, then yield, then (for WaitStrategy::block) park on a
+    // condition variable until notify() is called. Conditions are checked
+    // without holding the lock, so they may notify themselves.
+
+    class Waiter
+    {
+    public:
+      typedef std::chrono::steady_clock::time_point time_point;
+
+      explicit Waiter(WaitStrategy strategy);
+
+      // No copying
+      Waiter(const Waiter&)             = delete;
+      Waiter& operator= (const Waiter&) = delete;
+
+      // Changing the strategy assumes no concurrent operations
+      WaitStrategy strategy() const               { return strategy_; }
+      void         set_strategy(WaitStrategy strategy) { strategy_ = strategy; }
+
+      // Waits until the condition is true. Returns false if the deadline
+      // passes first, a deadline of time_point::min() checks it only once.
+      // 'checks' is set to the number of times the condition failed
+      template <class Condition>
+      bool wait_until(Condition condition, const time_point* deadline);
+      template <class Condition>
+      bool wait_until(Condition condition, const time_point* deadline, int& checks);
+
+      // Wakes parked threads, after any change a condition may wait for
+      void notify();
+
+      // Hints to the cpu that this is a spin-wait loop
+      static void relax();
+
+      // Number of checks a waiting thread makes before it starts yielding,
+      // and the number of yields before it parks
+      static const int SPIN_LIMIT  = 256;
+      static const int YIELD_LIMIT = 64;
+
+    private:
+      template <class Condition>
+      bool park_(Condition& condition, const time_point* deadline);
+
+      WaitStrategy strategy_;
+
+      alignas(64)
+      std::atomic<int>           waiters_; // number of parked threads
+      std::atomic<std::uint64_t> wakes_;   // raised by each notification
+      std::mutex                 lock_;
+      std::condition_variable    cond_;
+
+    }; // class Waiter
+
+    template <class Condition>
+    bool Waiter::wait_until(Condition condition, const time_point* deadline)
+    {
+      int checks;
+      return wait_until(condition, deadline, checks);
+    }
+
+    template <class Condition>
+    bool Waiter::wait_until(Condition condition, const time_point* deadline, int& checks)
+    {
+      auto ready = true;
+      auto i = 0;
+      for (; !condition(); ++i)
+      {
+        if (deadline != nullptr && (*deadline == time_point::min() || std::chrono::steady_clock::now() >= *deadline))
+        {
+          ready = false;
+          break;
+        }
+        else if (strategy_ == WaitStrategy::spin || i < SPIN_LIMIT)
+        {
+          relax();
+        }
+        else if (strategy_ == WaitStrategy::backoff || i < SPIN_LIMIT + YIELD_LIMIT)
+        {
+          std::this_thread::yield();
+        }
+        else
+        {
+          ready = park_(condition, deadline);
+          break;
+        }
+      }
+
+      checks = i;
+      return ready;
+    }
+
+    template <class Condition>
+    bool Waiter::park_(Condition& condition, const time_point* deadline)
+    {
+      // The waiter count is raised before checking the condition, so either
+      // the check sees the change or notify() sees the waiter and raises
+      // wakes_ before it locks, which this thread sees once it holds the
+      // lock. The condition is checked without the lock since it may try an
+      // operation that notifies
+
+      waiters_.fetch_add(1);
+      auto ready = true;
+      while (true)
+      {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        auto wakes = wakes_.load();
+        if (condition())
+          break;
+
+        std::unique_lock<std::mutex> lock(lock_);
+        if (deadline == nullptr)
+        {
+          while (wakes_.load() == wakes)
+            cond_.wait(lock);
+        }
+        else if (!cond_.wait_until(lock, *deadline, [&]{ return wakes_.load() != wakes; }))
+        {
+          lock.unlock();
+          ready = condition();
+          break;
+        }
+      }
+      waiters_.fetch_sub(1);
+
+      return ready;
+    }
+
+    // Wraps a position into a capacity that isn't a power of two without
+    // dividing. Positions in use are never more than a lap from each other,
+    // so they are almost always within a lap of 'lap', a recent lap start
+    // that the threads move along as the ring goes around. Any lap start
+    // wraps correctly, so threads may race to move it and it is only a hint
+    inline std::uint64_t wrap(std::uint64_t pos, std::uint64_t size, std::atomic<std::uint64_t>& lap)
+    {
+      auto start = lap.load(std::memory_order_relaxed);
+      auto offset = pos - start;
+      if (offset < size)                                    // in this lap
+        return offset;
+
+      if (start - pos <= size)                              // in the last lap
+        return size - (start - pos);
+
+      if (offset < 2 * size)                                // in the next lap
+      {
+        lap.store(start + size, std::memory_order_relaxed);
+        return offset - size;
+      }
+
+      start = pos - pos % size;                             // far off, divide
+      lap.store(start, std::memory_order_relaxed);
+      return pos - start;
+    }
+
+  } // namespace detail
+
+  //////////////////////////////////////////////////////////////////////////////
+  // Determines when a ring opened from a file syncs the file. Process crashes
+  // lose nothing either way since the mapping is the file's page cache, this
+  // only matters if the system goes down.
+  //
+  //   none     - the file is only synced by flush() or by the system
+  //   commit   - every write syncs its data before committing it, then the
+  //              header with the new positions. Writes are much slower
+  //   periodic - commits sync the whole file if flush_interval has passed
+  //              since the last sync
+
+  enum class FlushPolicy
+  {
+    none,
+    commit,
+    periodic
+  };
+
+  //////////////////////////////////////////////////////////////////////////////
+  // Options for constructing a ring
+
+  struct RingOptions
+  {
+    WaitStrategy wait;            // how blocking operations wait
+    bool         single_producer; // only one thread ever writes
+    bool         single_consumer; // only one thread ever reads
+    bool         power_of_two;    // round the capacity up to a power of two
+                                  // (the element count for Ring<T>)
+    bool         mirrored;        // map the buffer twice so blocks are always
+                                  // contiguous, rounds the capacity up to the
+                                  // page size (or allocation granularity)
+    std::size_t  alignment;       // alignment of the buffer, a power of two
+                                  // (0 for the default of new[]), larger
+                                  // than the page size isn't supported for
+                                  // mirrored rings or on Windows
+    bool         huge_pages;      // back the buffer with huge pages, or hint
+                                  // for transparent huge pages, if possible
+    int          numa_node;       // NUMA node to bind the buffer to (-1 for
+                                  // wherever it is first touched)
+    bool         prefault;        // touch every page at construction so no
+                                  // operation takes a page fault
+    bool         overwrite;       // writes to a full ring drop the oldest
+                                  // data instead of waiting for readers,
+                                  // which makes the ring multi-consumer
+    bool         events;          // create pollable readiness events (see
+                                  // Ring_::read_event)
+    std::size_t  streaming_threshold; // writes of at least this many bytes
+                                  // (or MessageRing messages) copy into the
+                                  // ring with non-temporal stores that
+                                  // bypass the writer's cache, if the cpu
+                                  // has them (0 for never)
+    FlushPolicy  flush;           // when rings opened from a file sync it
+    std::chrono::milliseconds flush_interval; // for FlushPolicy::periodic
+
+    RingOptions()
+      : wait(WaitStrategy::spin)
+      , single_producer(false)
+      , single_consumer(false)
+      , power_of_two(false)
+      , mirrored(false)
+      , alignment(0)
+      , huge_pages(false)
+      , numa_node(-1)
+      , prefault(false)
+      , overwrite(false)
+      , events(false)
+      , streaming_threshold(0)
+      , flush(FlushPolicy::none)
+      , flush_interval(100)
+    { }
+
+  }; // struct RingOptions
+
+  //////////////////////////////////////////////////////////////////////////////
+  // Counters describing contention on a ring, only collected if the library
+  // is compiled with WILT_RING_STATS defined (for ring.cpp and everything
+  // including ring.h alike, since it changes the size of Ring_). Otherwise
+  // they are all 0. Waits are counted in checks of the condition, so they
+  // measure time spent waiting regardless of the wait strategy.
+
+  struct RingStats
+  {
+    std::uint64_t read_retries;  // read commits that lost to another reader
+    std::uint64_t write_retries; // write commits that lost to another writer
+    std::uint64_t empty_stalls;  // reads that had to wait for data
+    std::uint64_t full_stalls;   // writes that had to wait for space
+    std::uint64_t wait_spins;    // checks made while waiting for data or space
+    std::uint64_t release_waits; // checks made while releasing a block out of
+                                 // order with its pending entry taken
+    std::uint64_t high_water;    // most data held at once, in bytes
+
+    RingStats()
+      : read_retries(0)
+      , write_retries(0)
+      , empty_stalls(0)
+      , full_stalls(0)
+      , wait_spins(0)
+      , release_waits(0)
+      , high_water(0)
+    { }
+
+  }; // struct RingStats
+
+  //////////////////////////////////////////////////////////////////////////////
+  // Segments of a scatter/gather operation, like iovec. A gather write
+  // copies the segments into one reservation in order, and a scatter read
+  // fills them in order from one reservation, so the data is moved as a
+  // whole without interleaving with other operations
+
+  struct WriteSegment
+  {
+    const void* data;
+    std::size_t length;
+  };
+
+  struct ReadSegment
+  {
+    void*       data;
+    std::size_t length;
+  };
+
+  //////////////////////////////////////////////////////////////////////////////
+  // Tags for selecting how many threads may access each side of a Ring<T>
+
+  namespace producers
+  {
+    struct single { }; // only one thread ever writes
+    struct multi  { }; // any number of threads may write
+  }
+
+  namespace consumers
+  {
+    struct single { }; // only one thread ever reads
+    struct multi  { }; // any number of threads may read
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  // Tags for selecting whether a Ring<T> measures how long elements wait
+
+  namespace timing
+  {
+    struct none    { }; // elements are stored as they are
+    struct stamped { }; // elements are stored with the time they were written
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  // Tags for selecting what writes do when readers fall a full ring behind
+
+  namespace overflow
+  {
+    struct block     { }; // writes wait for the slowest reader
+    struct overwrite { }; // writes replace the oldest data, readers that fall
+                          // behind skip ahead and count what they missed
+  }
 
   class Ring_
   {
-  private:
+  public:
     ////////////////////////////////////////////////////////////////////////////
     // TYPE DEFINITIONS
     ////////////////////////////////////////////////////////////////////////////
 
+    typedef std::chrono::steady_clock::time_point time_point;
+
+#if defined(_WIN32)
+    typedef void* event_handle; // handle of a manual-reset event
+#else
+    typedef int   event_handle; // file descriptor that polls readable
+#endif
+
+  private:
+
     typedef char*                       data_ptr;
-    typedef std::atomic<std::ptrdiff_t> size_type;
-    typedef std::atomic<char*>          atom_ptr;
+    typedef std::atomic<std::uint64_t>  atom_pos;
+
+  protected:
+
+    // Suspended coroutines are kept in a lock-free stack that commits take
+    // as a whole, trying each waiter's operation again. Waiters live in the
+    // coroutine frames, and only the thread that took one from the stack may
+    // touch it, so a waiter is never read once it has been pushed
+
+    struct async_waiter_
+    {
+      async_waiter_* next;
+      bool (*attempt)(async_waiter_*); // tries the operation, resuming the
+                                       // coroutine if it succeeds
+      bool        write;               // whether the operation writes
+      std::size_t length;              // bytes the operation needs
+    };
 
   private:
     ////////////////////////////////////////////////////////////////////////////
     // PRIVATE MEMBERS
     ////////////////////////////////////////////////////////////////////////////
     // Beginning and end pointers don't need to be atomic because they don't 
-    // change. used_ and free_ can be negative in certain cases (and that's ok).
+    // change. The positions are kept together so that shared rings can place
+    // them in the shared segment, otherwise ctl_ points to own_. Each group
+    // is only written by one side, and the positions the other side reads
+    // are kept apart from the ones it doesn't.
+
+    // Blocks released before the blocks ahead of them wait in a table, at an
+    // entry picked by hashing their position. 'start' is EMPTY_PENDING when
+    // the entry is free and BUSY_PENDING while it's being filled.
+
+    struct pending_
+    {
+      atom_pos start; // position of the released block
+      atom_pos end;   // position of the end of the released block
+    };
+
+    static const int PENDING_BITS = 6;
+    static const int PENDING      = 1 << PENDING_BITS;
+
+    struct control_
+    {
+      alignas(64)
+      atom_pos rptr;   // position of beginning of data
+      atom_pos rcache; // readers' copy of wptr
+
+      alignas(64)
+      atom_pos rbuf;   // position of beginning of data being read
+
+      alignas(64)
+      atom_pos wbuf;    // position of end of data being written
+      atom_pos wcache;  // writers' copy of rbuf
+      atom_pos dropped; // amount of data overwriting writes dropped
+
+      alignas(64)
+      atom_pos wptr;   // position of end of data
+
+      alignas(64)
+      pending_  reads[PENDING];  // reads released out of order
+
+      alignas(64)
+      pending_  writes[PENDING]; // writes released out of order
+
+      // Constructs the state of an empty ring
+      control_();
+
+      // Copies the state of another ring, assumes no concurrent operations
+      void assign(const control_& control);
+
+    }; // struct control_
+
+    struct shared_header_;
+
+    data_ptr      beg_;  // pointer to beginning of data block
+    data_ptr      end_;  // pointer to end of data block
+    std::uint64_t mask_;     // wraps positions if the capacity is a power of two
+    std::atomic<std::uint64_t> lap_; // start of a recent lap, wraps positions
+                                     // without dividing if there's no mask
+    bool          mirrored_; // buffer is mapped twice, back to back
+    std::size_t   mapped_;   // size of the mapping if the buffer was mapped
+                             // directly (not mirrored), 0 if it uses new[]
+    data_ptr      shared_;   // shared segment holding the header, control
+                             // and buffer, nullptr if the ring isn't shared
+    control_*     ctl_;      // positions and counters of the ring
+
+    control_      own_;
+
+    bool         single_producer_; // writes need not be ordered
+    bool         single_consumer_; // reads need not be ordered
+    bool         overwrite_;       // writes drop data instead of waiting
+    std::size_t  streaming_;       // smallest write copied with non-temporal
+                                   // stores, 0 to always use memcpy
+
+    std::size_t  drop_header_;                  // header size of records
+    std::size_t  (*drop_measure_)(const char*); // length of a record, or
+                                                // nullptr to drop bytes
 
-    data_ptr  beg_;  // pointer to beginning of data block
-    data_ptr  end_;  // pointer to end of data block
+    FlushPolicy                         flush_;          // when the file is synced
+    std::chrono::steady_clock::duration flush_interval_; // for FlushPolicy::periodic
+    std::atomic<std::int64_t>           next_flush_;     // time of the next periodic sync
 
-    alignas(64)
-    size_type used_; // size of unreserved used space
+    detail::Waiter waiter_; // how blocking operations wait, parked threads
+                            // are only notified if there are any
 
-    alignas(64)
-    size_type free_; // size of unreserved free space
+    std::atomic<async_waiter_*> async_waiters_; // suspended coroutines
 
-    alignas(64)
-    atom_ptr  rbuf_; // pointer to beginning of data being read
-    atom_ptr  rptr_; // pointer to beginning of data
+    // Readiness events are signaled by the first commit after they were
+    // cleared, so only one commit per wait makes a system call
 
-    alignas(64)
-    atom_ptr  wptr_; // pointer to end of data
-    atom_ptr  wbuf_; // pointer to end of data being written
+    struct event_set_;
+
+    event_set_* events_; // nullptr without RingOptions::events
+
+    // Statistics are striped across cache lines, each thread counts in one
+    // of the stripes and stats() adds them up
+
+    enum stat_
+    {
+      STAT_READ_RETRIES,
+      STAT_WRITE_RETRIES,
+      STAT_EMPTY_STALLS,
+      STAT_FULL_STALLS,
+      STAT_WAIT_SPINS,
+      STAT_RELEASE_WAITS,
+      STAT_COUNT
+    };
+
+#ifdef WILT_RING_STATS
+    static const int STAT_STRIPES = 16;
+
+    struct alignas(64) stat_stripe_
+    {
+      std::atomic<std::uint64_t> counts[STAT_COUNT];
+    };
+
+    stat_stripe_               stats_[STAT_STRIPES];
+    std::atomic<std::uint64_t> high_water_; // most data held at once
+#endif
 
   public:
     ////////////////////////////////////////////////////////////////////////////
@@ -137,6 +652,7 @@ namespace wilt
 
     // Constructs a ring with a buffer with a size
     Ring_(std::size_t size);
+    Ring_(std::size_t size, const RingOptions& options);
 
     // Moves the buffer between rings, assumes no concurrent operations
     Ring_(Ring_&& ring);
@@ -158,62 +674,465 @@ namespace wilt
     ////////////////////////////////////////////////////////////////////////////
     // Functions only report on the state of the ring
 
-    // Returns the current amount of non-reserved used space (amount of written 
-    // data that a read hasn't yet reserved). Over-reserved scenarios mean this
-    // number is not the ultimate source of truth with concurrent operations,
-    // but its the closest safe approximation. This, of course, doesn't report
-    // writes that have not completed.
+    // Returns the current amount of unclaimed data (amount of written data that
+    // a read hasn't yet reserved). This is exact at the time the positions are
+    // read, but doesn't report writes that have not completed.
     std::size_t size() const;
 
     // Maximum amount of data that can be held
     std::size_t capacity() const;
 
+    // Returns whether the buffer is mirrored, meaning blocks never wrap. This
+    // may be false even if it was requested, if the platform doesn't support
+    // it or the mapping failed
+    bool mirrored() const;
+
+    // Returns whether the ring is in a shared memory segment
+    bool shared() const;
+
+    // Returns the amount of data overwriting writes have dropped so far.
+    // Readers can also tell they missed data from a gap in the positions of
+    // the blocks they reserve
+    std::uint64_t dropped() const;
+
+    // Returns the counters collected so far (see RingStats), reset_stats sets
+    // them back to 0. The counters are read individually, so a snapshot taken
+    // during operations isn't exact
+    RingStats stats() const;
+    void reset_stats();
+
+    // With RingOptions::events, returns handles for waiting on the ring with
+    // poll, epoll, kqueue or WaitForMultipleObjects. The read event becomes
+    // ready when data is committed and the write event when space is
+    // released (it starts out ready). Both stay ready until cleared. Returns
+    // -1 (nullptr on Windows) without events, or if they couldn't be created
+    event_handle read_event() const;
+    event_handle write_event() const;
+
   public:
     ////////////////////////////////////////////////////////////////////////////
     // ACCESSORS AND MODIFIERS
     ////////////////////////////////////////////////////////////////////////////
     // All operations assume object has not been moved. Blocking operations run
     // until operation is completed. Non-blocking operations fail if there is
-    // not enough space
+    // not enough space. Timed operations block until the operation is
+    // completed or fail once the timeout or deadline has passed
 
     void read(void* data, std::size_t length) noexcept;
     void write(const void* data, std::size_t length) noexcept;
     bool try_read(void* data, std::size_t length) noexcept;
     bool try_write(const void* data, std::size_t length) noexcept;
 
+    // Scatter/gather operations move 'count' segments as a single block of
+    // their total length (see WriteSegment)
+    void read(const ReadSegment* segments, std::size_t count) noexcept;
+    void write(const WriteSegment* segments, std::size_t count) noexcept;
+    bool try_read(const ReadSegment* segments, std::size_t count) noexcept;
+    bool try_write(const WriteSegment* segments, std::size_t count) noexcept;
+
+    // Makes an event not ready, so the next commit signals it again. Readers
+    // clear the read event before draining the ring and wait on it once
+    // reads fail, writers do the same with the write event. Only commits in
+    // this process signal events
+    void clear_read_event();
+    void clear_write_event();
+
+    template <class Rep, class Period>
+    bool read_for(void* data, std::size_t length, const std::chrono::duration<Rep, Period>& timeout) noexcept;
+    bool read_until(void* data, std::size_t length, time_point deadline) noexcept;
+
+    template <class Rep, class Period>
+    bool write_for(const void* data, std::size_t length, const std::chrono::duration<Rep, Period>& timeout) noexcept;
+    bool write_until(const void* data, std::size_t length, time_point deadline) noexcept;
+
+    // Reads whatever data is available up to 'length' and returns the amount
+    // read. The blocking read waits until there is at least one byte and the
+    // non-blocking read returns 0 if there is none
+    std::size_t read_some(void* data, std::size_t length) noexcept;
+    std::size_t try_read_some(void* data, std::size_t length) noexcept;
+
+    // Peeking copies the data at the front of the ring without claiming it,
+    // so the next read gets the same data. With multiple consumers the copy
+    // is validated like a seqlock, by checking that no read claimed the data
+    // while it was copied, and retried if one did. Skipping claims and
+    // releases data without copying it
+    void peek(void* data, std::size_t length) noexcept;
+    bool try_peek(void* data, std::size_t length) noexcept;
+    void skip(std::size_t length) noexcept;
+    bool try_skip(std::size_t length) noexcept;
+
+    // Moves data between the ring and a file descriptor (a socket, pipe or
+    // file) with one readv or writev whose iovecs are the two spans of a
+    // block, so the kernel copies straight into or out of the ring.
+    // read_from_fd waits for space and reads at most 'max' bytes into it,
+    // write_to_fd waits for data and writes at most 'max' bytes of it. Both
+    // return the amount moved, 0 at the end of the file, or -1 with errno
+    // set if the call fails (EAGAIN for an empty non-blocking descriptor).
+    //
+    // Space or data the call didn't use is given back, so read_from_fd needs
+    // RingOptions::single_producer and write_to_fd needs single_consumer.
+    // Neither works on overwriting rings, since read_from_fd would drop data
+    // to make room for bytes that may never arrive and write_to_fd has no
+    // single consumer. Both fail with EINVAL otherwise, and with ENOSYS on
+    // Windows
+    std::ptrdiff_t read_from_fd(int fd, std::size_t max) noexcept;
+    std::ptrdiff_t write_to_fd(int fd, std::size_t max) noexcept;
+
+  public:
+    ////////////////////////////////////////////////////////////////////////////
+    // RESERVATIONS
+    ////////////////////////////////////////////////////////////////////////////
+    // Reservations expose a block of the ring directly so that data can be
+    // encoded or decoded in place instead of being copied through a separate
+    // buffer. A block that wraps around the end of the buffer is split into
+    // two spans, otherwise (and always for mirrored rings) second_size() is 0.
+    // The block is committed by commit() or when the handle is destroyed.
+    // Since blocks are committed in order, later blocks aren't visible until
+    // earlier reservations are committed, so they should be held as briefly
+    // as possible.
+
+    class WriteBlock
+    {
+    public:
+      // Constructs an empty block (holds no reservation)
+      WriteBlock();
+
+      // Moves the reservation between blocks
+      WriteBlock(WriteBlock&& block);
+      WriteBlock& operator= (WriteBlock&& block);
+
+      // No copying
+      WriteBlock(const WriteBlock&)             = delete;
+      WriteBlock& operator= (const WriteBlock&) = delete;
+
+      // Commits the block if it hasn't already been
+      ~WriteBlock();
+
+      explicit operator bool() const { return ring_ != nullptr; }
+
+      char*       first() const        { return first_; }
+      std::size_t first_size() const   { return first_size_; }
+      char*       second() const       { return second_; }
+      std::size_t second_size() const  { return second_size_; }
+      std::size_t size() const         { return first_size_ + second_size_; }
+
+      // Makes the written data available to readers, the block is empty
+      // afterwards
+      void commit() noexcept;
+
+    private:
+      friend class Ring_;
+      WriteBlock(Ring_* ring, char* block, std::uint64_t pos, std::size_t length);
+
+      Ring_*        ring_;
+      std::uint64_t pos_;
+      char*         first_;
+      std::size_t   first_size_;
+      char*         second_;
+      std::size_t   second_size_;
+
+    }; // class WriteBlock
+
+    class ReadBlock
+    {
+    public:
+      // Constructs an empty block (holds no reservation)
+      ReadBlock();
+
+      // Moves the reservation between blocks
+      ReadBlock(ReadBlock&& block);
+      ReadBlock& operator= (ReadBlock&& block);
+
+      // No copying
+      ReadBlock(const ReadBlock&)             = delete;
+      ReadBlock& operator= (const ReadBlock&) = delete;
+
+      // Commits the block if it hasn't already been
+      ~ReadBlock();
+
+      explicit operator bool() const { return ring_ != nullptr; }
+
+      const char* first() const        { return first_; }
+      std::size_t first_size() const   { return first_size_; }
+      const char* second() const       { return second_; }
+      std::size_t second_size() const  { return second_size_; }
+      std::size_t size() const         { return first_size_ + second_size_; }
+
+      // Position of the block in the stream of data written to the ring
+      std::uint64_t position() const   { return pos_; }
+
+      // Returns the space to writers, the block is empty afterwards
+      void commit() noexcept;
+
+    private:
+      friend class Ring_;
+      ReadBlock(Ring_* ring, char* block, std::uint64_t pos, std::size_t length);
+
+      Ring_*        ring_;
+      std::uint64_t pos_;
+      char*         first_;
+      std::size_t   first_size_;
+      char*         second_;
+      std::size_t   second_size_;
+
+    }; // class ReadBlock
+
+    // Blocking reservations run until the space or data is available.
+    // Non-blocking reservations return an empty block if there is not enough
+    WriteBlock reserve_write(std::size_t length) noexcept;
+    WriteBlock try_reserve_write(std::size_t length) noexcept;
+    ReadBlock  reserve_read(std::size_t length) noexcept;
+    ReadBlock  try_reserve_read(std::size_t length) noexcept;
+
+  public:
+    ////////////////////////////////////////////////////////////////////////////
+    // SHARED RINGS
+    ////////////////////////////////////////////////////////////////////////////
+    // A shared ring keeps its positions, counters and buffer in a named shared
+    // memory segment (a POSIX shared memory object or a named file mapping on
+    // Windows) so that rings in different processes can operate on the same
+    // data. The segment starts with a header holding a magic number, a layout
+    // version, the capacity and whether the ring is single producer or single
+    // consumer, which all processes must respect.
+    //
+    // create_shared fails if the segment already exists and open_shared fails
+    // if it doesn't or isn't a ring of this version. Failures return a ring
+    // without a buffer (capacity() == 0). Shared rings are never mirrored, and
+    // WaitStrategy::block backs off instead of parking since threads parked
+    // in one process can't be woken by another. For the same reason, events
+    // from RingOptions::events belong to the ring in this process and are
+    // only signaled by its commits. The segment lives until it is removed
+    // with remove_shared and every ring using it is destroyed.
+
+    static Ring_ create_shared(const char* name, std::size_t size);
+    static Ring_ create_shared(const char* name, std::size_t size, const RingOptions& options);
+    static Ring_ open_shared(const char* name);
+    static Ring_ open_shared(const char* name, WaitStrategy wait);
+    static bool  remove_shared(const char* name);
+
+    // A ring opened from a file is a shared ring backed by that file, so the
+    // data and positions persist. If the file is empty it is set up as a ring
+    // with a size and the options, otherwise the ring is recovered from it and
+    // the size and the producer and consumer options of the file are used:
+    // writes that weren't committed are dropped and reads that weren't
+    // released are replayed, so each message is read at least once. Recovery
+    // assumes no other process is using the file
+    static Ring_ open_file(const char* path, std::size_t size);
+    static Ring_ open_file(const char* path, std::size_t size, const RingOptions& options);
+
+    // Syncs the whole mapping of a file ring to the file, blocking until it
+    // is written. Does nothing for other rings
+    void flush();
+
   protected:
     ////////////////////////////////////////////////////////////////////////////
     // PROTECTED FUNCTIONS
     ////////////////////////////////////////////////////////////////////////////
     // Helper functions
 
+    // Allocates the buffer, setting beg_, end_, mirrored_ and mapped_, and
+    // frees it again (or unmaps the shared segment)
+    void  allocate_(std::size_t size, const RingOptions& options);
+    void  deallocate_();
+
     // Wraps a pointer within the array. Assumes 'beg_ <= ptr < end_+capacity()'
     char* normalize_(char*);
 
-    char* acquire_read_block_(std::size_t length);
-    char* try_acquire_read_block_(std::size_t length);
+    // Returns the pointer into the array for a position. Without a mask the
+    // position is wrapped relative to lap_ (see detail::wrap)
+    char* block_(std::uint64_t pos);
+
+    // Returns the total length of the segments
+    static std::size_t segments_length_(const ReadSegment* segments, std::size_t count);
+    static std::size_t segments_length_(const WriteSegment* segments, std::size_t count);
+
+    // Waits according to the wait strategy until the condition is true.
+    // Returns false if the deadline passes first. 'stall' is the counter that
+    // waiting adds to
+    template <class Condition>
+    bool  wait_until_(Condition condition, const time_point* deadline, stat_ stall);
+
+    // Adds to a statistic, or does nothing without WILT_RING_STATS
+    void  count_(stat_ stat, std::uint64_t count = 1);
+    void  count_high_water_(std::uint64_t wptr);
+
+    // Wakes parked threads after the state of the ring has changed, and
+    // tries the operations of suspended coroutines again
+    void  notify_();
+
+    // Signals the read or write event unless it's already signaled
+    void  signal_event_(bool read);
+
+    // Pushes a waiter whose operation failed onto the stack, then takes the
+    // stack if the operation may succeed by now so no commit is missed. The
+    // check uses a copy of the waiter's operation, since another thread may
+    // resume the coroutine and free the waiter as soon as it's pushed.
+    // wake_async_ takes the stack and tries every waiter, parking them again
+    // if they fail
+    void  park_async_(async_waiter_* waiter);
+    void  wake_async_();
+
+    // Returns whether 'length' bytes could be read or written now. Overwriting
+    // rings can also write when there is data to drop
+    bool  readable_(std::size_t length) const;
+    bool  writable_(std::size_t length) const;
+
+    // Moves 'front' (rbuf or wptr) past a released block, and past any blocks
+    // after it waiting in 'pending'. If blocks before it aren't released yet,
+    // leaves it in 'pending' instead. Returns where this thread moved 'front'
+    // to, or 'pos' if it didn't move it
+    std::uint64_t publish_(atom_pos& front, pending_* pending, std::uint64_t pos, std::uint64_t end);
+
+    // Sets up the header of a shared segment, or takes the ring's state from
+    // one. attach_ returns false if the segment isn't a valid ring
+    static void format_(char* segment, std::size_t offset, std::size_t size, const RingOptions& options);
+    bool  attach_(char* segment, std::size_t mapped, WaitStrategy wait);
+
+    // Creates the readiness events, leaving events_ null if that fails
+    void  create_events_();
+
+    // Resets the positions of a reopened file ring to the committed ones.
+    // Returns false if they aren't valid
+    bool  recover_();
+
+    // Syncs a block's data, and the header or the whole file according to the
+    // flush policy after a commit
+    void  sync_block_(std::uint64_t pos, std::size_t length);
+    void  sync_commit_();
+
+    // Returns the data after 'rptr' or the space after 'wbuf' according to
+    // the side's copy of the other side's position, refreshing the copy if
+    // it shows less than 'size'
+    std::ptrdiff_t cache_used_(std::uint64_t rptr, std::ptrdiff_t size);
+    std::ptrdiff_t cache_free_(std::uint64_t wbuf, std::ptrdiff_t size);
+
+    // Returns the space after 'wbuf' like cache_free_, first dropping the
+    // oldest data to make room for 'size' if the ring overwrites
+    std::ptrdiff_t make_room_(std::uint64_t wbuf, std::ptrdiff_t size);
+
+    // Claims the data before 'target' like a read and releases it unread,
+    // as far as it has been committed. drop_records_ makes it drop whole
+    // records measured like acquire_measured_read_block_ instead of bytes
+    void  drop_(std::uint64_t target);
+    void  drop_records_(std::size_t header, std::size_t (*measure)(const char*));
+
+    // Acquires return the block and set 'pos' to its position, which is then
+    // needed to release it. Blocking acquires return nullptr if the deadline
+    // passes
+    char* acquire_read_block_(std::size_t length, std::uint64_t& pos, const time_point* deadline = nullptr);
+    char* try_acquire_read_block_(std::size_t length, std::uint64_t& pos);
+
+    // Acquires as much data as is available, up to 'length' and in multiples
+    // of 'unit'. 'length' is updated with the size acquired
+    char* acquire_some_read_block_(std::size_t& length, std::size_t unit, std::uint64_t& pos);
+    char* try_acquire_some_read_block_(std::size_t& length, std::size_t unit, std::uint64_t& pos);
+
+    // Acquires a block whose length is decided by its first 'header' bytes
+    // (at most 16), 'measure' is given them and returns the block's length.
+    // 'length' is set to the size acquired
+    char* acquire_measured_read_block_(std::size_t header, std::size_t (*measure)(const char*), std::size_t& length, std::uint64_t& pos, const time_point* deadline = nullptr);
+    char* try_acquire_measured_read_block_(std::size_t header, std::size_t (*measure)(const char*), std::size_t& length, std::uint64_t& pos);
     void  copy_read_block_(const char* block, char* data, std::size_t length);
-    void  release_read_block_(char* block, std::size_t length);
-
-    char* acquire_write_block_(std::size_t length);
-    char* try_acquire_write_block_(std::size_t length);
+    void  scatter_read_block_(const char* block, const ReadSegment* segments, std::size_t count);
+
+    // Returns the block of 'length' committed bytes at the front of the ring
+    // without claiming it, setting 'pos' to its position. The block may be
+    // claimed and overwritten at any time unless this is the only reader,
+    // peek_valid_ returns whether it was still unclaimed after reading it
+    const char* peek_block_(std::size_t length, std::uint64_t& pos, const time_point* deadline = nullptr);
+    const char* try_peek_block_(std::size_t length, std::uint64_t& pos);
+    bool  peek_valid_(std::uint64_t pos) const;
+
+    // Gives back the end of an acquired block so only 'used' bytes of it are
+    // released. Only for single consumer or producer rings, since otherwise
+    // a later block may already follow it
+    void  shrink_read_block_(std::uint64_t pos, std::size_t used);
+    void  release_read_block_(std::uint64_t pos, std::size_t length);
+
+    char* acquire_write_block_(std::size_t length, std::uint64_t& pos, const time_point* deadline = nullptr);
+    char* try_acquire_write_block_(std::size_t length, std::uint64_t& pos);
+
+    // Acquires as much space as is available, at least a byte and at most
+    // 'length'. 'length' is updated with the size acquired
+    char* acquire_some_write_block_(std::size_t& length, std::uint64_t& pos);
+    void  shrink_write_block_(std::uint64_t pos, std::size_t used);
+
+    // Acquires a block that is contiguous in the array by also acquiring the
+    // space up to the end of the array if the block would wrap. 'padding' is
+    // set to the amount of extra space at the start of the block and 'total'
+    // to the size acquired. If both don't fit in the ring, only the padding
+    // is acquired
+    char* acquire_padded_write_block_(std::size_t length, std::size_t& padding, std::size_t& total, std::uint64_t& pos, const time_point* deadline = nullptr);
+    char* try_acquire_padded_write_block_(std::size_t length, std::size_t& padding, std::size_t& total, std::uint64_t& pos);
     void  copy_write_block_(char* block, const char* data, std::size_t length);
-    void  release_write_block_(char* block, std::size_t length);
+    void  gather_write_block_(char* block, const WriteSegment* segments, std::size_t count);
+    void  release_write_block_(std::uint64_t pos, std::size_t length);
 
     char* begin_alloc_()             { return beg_;  }
     const char* begin_alloc_() const { return beg_;  }
     char* end_alloc_()               { return end_;  }
     const char* end_alloc_() const   { return end_;  }
-    char* begin_data_()              { return rptr_; }
-    const char* begin_data_() const  { return rptr_; }
-    char* end_data_()                { return wptr_; }
-    const char* end_data_() const    { return wptr_; }
+    std::uint64_t begin_data_() const { return ctl_->rptr; }
+    std::uint64_t end_data_() const   { return ctl_->wptr; }
 
   }; // class Ring_
 
-  template <class T>
+  template <class Rep, class Period>
+  bool Ring_::read_for(void* data, std::size_t length, const std::chrono::duration<Rep, Period>& timeout) noexcept
+  {
+    return read_until(data, length, std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(timeout));
+  }
+
+  template <class Rep, class Period>
+  bool Ring_::write_for(const void* data, std::size_t length, const std::chrono::duration<Rep, Period>& timeout) noexcept
+  {
+    return write_until(data, length, std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(timeout));
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  // Typed wrapper around Ring_. The producers and consumers tags say whether
+  // only a single thread ever writes or reads, which lets that side skip the
+  // reserve-commit protocol and the ordered release. With timing::stamped,
+  // each element is stored with the time it was written and every read
+  // records how long it was queued (in nanoseconds) in latency(). With
+  // overflow::overwrite, full rings drop the oldest elements (see
+  // RingOptions::overwrite), so elements must be trivially destructible.
+
+  template <class T, class P = producers::multi, class C = consumers::multi, class L = timing::none, class O = overflow::block>
   class Ring : protected Ring_
   {
+  public:
+    ////////////////////////////////////////////////////////////////////////////
+    // TYPE DEFINITIONS
+    ////////////////////////////////////////////////////////////////////////////
+
+    typedef Ring_::time_point   time_point;
+    typedef Ring_::event_handle event_handle;
+
+  private:
+
+    // Stamped elements are followed by the time they were written, aligned
+    // so that both the element and the stamp are aligned in every slot
+
+    static_assert(!std::is_same<O, overflow::overwrite>::value || std::is_trivially_destructible<T>::value, "T must be trivially destructible to overwrite");
+
+    static const bool        STAMPED      = std::is_same<L, timing::stamped>::value;
+    static const std::size_t STAMP_ALIGN  = alignof(T) > alignof(std::int64_t) ? alignof(T) : alignof(std::int64_t);
+    static const std::size_t STAMP_OFFSET = (sizeof(T) + alignof(std::int64_t) - 1) / alignof(std::int64_t) * alignof(std::int64_t);
+    static const std::size_t SLOT_SIZE    = STAMPED ? (STAMP_OFFSET + sizeof(std::int64_t) + STAMP_ALIGN - 1) / STAMP_ALIGN * STAMP_ALIGN : sizeof(T);
+    static const std::size_t SLOT_ALIGN   = STAMPED ? STAMP_ALIGN : alignof(T);
+
+    // Ranges of trivially copyable elements given by pointers are copied in
+    // and out of the buffer as a whole, unless they need stamps
+
+    template <class It>
+    struct is_raw_ : std::integral_constant<bool, !STAMPED && std::is_trivially_copyable<T>::value && std::is_pointer<It>::value
+      && std::is_same<typename std::remove_cv<typename std::remove_pointer<It>::type>::type, T>::value> { };
+
+    struct no_latency_ { };
+
+    typename std::conditional<STAMPED, LatencyHistogram, no_latency_>::type latency_;
+
   public:
     ////////////////////////////////////////////////////////////////////////////
     // CONSTRUCTORS AND DESTRUCTORS
@@ -224,13 +1143,14 @@ namespace wilt
 
     // Constructs a ring with a buffer with a size
     Ring(std::size_t size);
+    Ring(std::size_t size, const RingOptions& options);
 
     // Moves the buffer between rings, assumes no concurrent operations
-    Ring(Ring<T>&& ring);
+    Ring(Ring&& ring);
 
     // Moves the buffer between rings, assumes no concurrent operations on
     // either ring. Deallocates the buffer
-    Ring<T>& operator= (Ring<T>&& ring);
+    Ring& operator= (Ring&& ring);
 
     // No copying
     Ring(const Ring_&)             = delete;
@@ -245,16 +1165,27 @@ namespace wilt
     ////////////////////////////////////////////////////////////////////////////
     // Functions only report on the state of the ring
 
-    // Returns the current amount of non-reserved used space (amount of written 
-    // data that a read hasn't yet reserved). Over-reserved scenarios mean this
-    // number is not the ultimate source of truth with concurrent operations,
-    // but its the closest safe approximation. This, of course, doesn't report
-    // writes that have not completed.
+    // Returns the current number of unclaimed elements (written elements that
+    // a read hasn't yet reserved). This is exact at the time the positions are
+    // read, but doesn't report writes that have not completed.
     std::size_t size() const;
 
     // Maximum amount of data that can be held
     std::size_t capacity() const;
 
+    // Returns the number of elements dropped by overwriting writes so far,
+    // only for overflow::overwrite
+    std::uint64_t dropped() const;
+
+    // Queueing delays of the elements read so far, only for timing::stamped.
+    // Moving a ring doesn't move its histogram
+    const LatencyHistogram& latency() const;
+    LatencyHistogram& latency();
+
+    // Readiness events, with RingOptions::events (see Ring_::read_event)
+    event_handle read_event() const;
+    event_handle write_event() const;
+
   public:
     ////////////////////////////////////////////////////////////////////////////
     // ACCESSORS AND MODIFIERS
@@ -263,13 +1194,162 @@ namespace wilt
     // until operation is completed. Non-blocking operations fail if there is
     // not enough space
 
+    // Writes of a T whose copy can throw copy it before reserving space (even
+    // if a non-blocking write then fails), so only its move must not throw
+
     void read(T& data) noexcept;            // blocking read
-    void write(const T& data) noexcept;     // blocking write
+    void write(const T& data) noexcept(std::is_nothrow_copy_constructible<T>::value);
     void write(T&& data) noexcept;          // blocking write
     bool try_read(T& data) noexcept;        // non-blocking read
-    bool try_write(const T& data) noexcept; // non-blocking write
+    bool try_write(const T& data) noexcept(std::is_nothrow_copy_constructible<T>::value);
     bool try_write(T&& data) noexcept;      // non-blocking write
 
+    template <class Rep, class Period>
+    bool read_for(T& data, const std::chrono::duration<Rep, Period>& timeout) noexcept;
+    bool read_until(T& data, time_point deadline) noexcept;
+
+    template <class Rep, class Period>
+    bool write_for(const T& data, const std::chrono::duration<Rep, Period>& timeout) noexcept(std::is_nothrow_copy_constructible<T>::value);
+    template <class Rep, class Period>
+    bool write_for(T&& data, const std::chrono::duration<Rep, Period>& timeout) noexcept;
+    bool write_until(const T& data, time_point deadline) noexcept(std::is_nothrow_copy_constructible<T>::value);
+    bool write_until(T&& data, time_point deadline) noexcept;
+
+    // Makes an event not ready until the next commit (see Ring_)
+    void clear_read_event();
+    void clear_write_event();
+
+    // Emplacing constructs the element in the ring from the arguments, so no
+    // temporary is copied or moved in. Consuming calls 'f' with a reference
+    // to the element in the ring and destructs it afterwards, instead of
+    // moving it out. 'f' runs while the block is reserved, so later reads
+    // can't release until it returns, and it must not throw
+
+    template <class... Args>
+    void emplace(Args&&... args) noexcept;
+    template <class... Args>
+    bool try_emplace(Args&&... args) noexcept;
+
+    template <class F>
+    void consume(F&& f) noexcept;
+    template <class F>
+    bool try_consume(F&& f) noexcept;
+
+    // Peeking copies the next element without reading it (see Ring_::peek),
+    // which needs a single consumer that doesn't overwrite, or a trivially
+    // copyable T. peek_each calls 'f' with each committed element in order
+    // and returns how many it visited, which needs a single consumer that
+    // doesn't overwrite. Skipping reads and destructs elements without moving
+    // them out, blocking skips must not be larger than capacity(). Nothing is
+    // claimed while peeking, so a throwing copy or 'f' leaves the ring as is
+
+    void peek(T& data) noexcept(std::is_nothrow_copy_assignable<T>::value);
+    bool try_peek(T& data) noexcept(std::is_nothrow_copy_assignable<T>::value);
+
+    template <class F>
+    std::size_t peek_each(F&& f) noexcept(noexcept(f(std::declval<const T&>())));
+
+    void skip(std::size_t count) noexcept;
+    bool try_skip(std::size_t count) noexcept;
+
+    // Bulk operations reserve space for all the elements at once. Blocking
+    // bulk writes must not be larger than capacity(). Bulk reads return the
+    // number of elements read, blocking until at least one is available
+
+    template <class ForwardIt>
+    void write_bulk(ForwardIt first, ForwardIt last) noexcept;
+
+    template <class ForwardIt>
+    bool try_write_bulk(ForwardIt first, ForwardIt last) noexcept;
+
+    template <class OutputIt>
+    std::size_t read_bulk(OutputIt out, std::size_t max) noexcept;
+
+    template <class OutputIt>
+    std::size_t try_read_up_to(OutputIt out, std::size_t max) noexcept;
+
+#if WILT_RING_COROUTINES
+  public:
+    ////////////////////////////////////////////////////////////////////////////
+    // COROUTINE AWAITABLES
+    ////////////////////////////////////////////////////////////////////////////
+    // co_await async_read() returns the next element and co_await
+    // async_write(data) writes one, suspending the coroutine while the ring
+    // is empty or full instead of blocking the thread. The commit that makes
+    // room or data completes the operation and resumes the coroutine by
+    // calling 'executor' with its handle, which by default resumes it inline
+    // on the committing thread. An executor that posts the handle to an event
+    // loop keeps the coroutine on that loop instead.
+    //
+    // Resuming inline runs the coroutine inside the read, write or drop that
+    // made the commit, on that thread, before the call returns. It may use
+    // the ring again, but anything it blocks on holds up the committing
+    // thread too, so coroutines that block or run for long should use an
+    // executor that dispatches them.
+    //
+    // Suspended operations can't be cancelled, so the ring must outlive them.
+    // Commits by other processes on a shared ring don't resume coroutines.
+
+    struct InlineExecutor
+    {
+      void operator()(std::coroutine_handle<> handle) const { handle.resume(); }
+    };
+
+    template <class Executor>
+    class ReadAwaiter : private Ring_::async_waiter_
+    {
+    public:
+      bool await_ready() noexcept;
+      void await_suspend(std::coroutine_handle<> handle) noexcept;
+      T    await_resume() noexcept;
+
+    private:
+      friend class Ring;
+      ReadAwaiter(Ring* ring, Executor executor);
+
+      static bool attempt_(async_waiter_* waiter);
+
+      Ring*                   ring_;
+      Executor                executor_;
+      std::coroutine_handle<> handle_;
+      std::optional<T>        data_;
+
+    }; // class ReadAwaiter
+
+    template <class Executor>
+    class WriteAwaiter : private Ring_::async_waiter_
+    {
+    public:
+      bool await_ready() noexcept;
+      void await_suspend(std::coroutine_handle<> handle) noexcept;
+      void await_resume() noexcept { }
+
+    private:
+      friend class Ring;
+      template <class U>
+      WriteAwaiter(Ring* ring, U&& data, Executor executor);
+
+      static bool attempt_(async_waiter_* waiter);
+
+      Ring*                   ring_;
+      Executor                executor_;
+      std::coroutine_handle<> handle_;
+      T                       data_;
+
+    }; // class WriteAwaiter
+
+    ReadAwaiter<InlineExecutor> async_read() noexcept;
+    template <class Executor>
+    ReadAwaiter<Executor> async_read(Executor executor) noexcept;
+
+    WriteAwaiter<InlineExecutor> async_write(const T& data);
+    WriteAwaiter<InlineExecutor> async_write(T&& data);
+    template <class Executor>
+    WriteAwaiter<Executor> async_write(const T& data, Executor executor);
+    template <class Executor>
+    WriteAwaiter<Executor> async_write(T&& data, Executor executor);
+#endif
+
   private:
     ////////////////////////////////////////////////////////////////////////////
     // PRIVATE HELPER FUNCTIONS
@@ -277,164 +1357,864 @@ namespace wilt
 
     void destruct_();
 
+    // Constructs an element in a slot, and moves one out (or passes it to a
+    // callback) and destructs it, handling the stamp
+    template <class... Args>
+    void construct_(char* block, Args&&... args);
+
+    template <class U>
+    void take_(char* block, U&& out);
+
+    template <class F>
+    void consume_(char* block, F& f);
+
+    void record_stamp_(const char* block);
+
+    // Copies an element out of a peeked slot, through a buffer for trivially
+    // copyable elements since a concurrent write may tear it
+    void peek_(const char* block, T& data, std::false_type);
+    void peek_(const char* block, T& data, std::true_type);
+
+    void destruct_block_(char* block, std::size_t count);
+
+    static void record_latency_(LatencyHistogram& latency, std::uint64_t delay) { latency.record(delay); }
+    static void record_latency_(no_latency_&, std::uint64_t)                   { }
+
+    static RingOptions options_(RingOptions options);
+    static std::size_t round_size_(std::size_t size, const RingOptions& options);
+
+    template <class ForwardIt>
+    void construct_block_(char* block, ForwardIt first, ForwardIt last);
+    template <class ForwardIt>
+    void construct_block_(char* block, ForwardIt first, ForwardIt last, std::false_type);
+    template <class ForwardIt>
+    void construct_block_(char* block, ForwardIt first, ForwardIt last, std::true_type);
+
+    template <class OutputIt>
+    OutputIt move_block_(char* block, std::size_t count, OutputIt out);
+    template <class OutputIt>
+    OutputIt move_block_(char* block, std::size_t count, OutputIt out, std::false_type);
+    template <class OutputIt>
+    OutputIt move_block_(char* block, std::size_t count, OutputIt out, std::true_type);
+
   }; // class Ring<T>
 
-  template <class T>
-  Ring<T>::Ring()
+  template <class T, class P, class C, class L, class O>
+  Ring<T, P, C, L, O>::Ring()
     : Ring_()
   { }
 
-  template <class T>
-  Ring<T>::Ring(std::size_t size)
-    : Ring_(size * sizeof(T))
+  template <class T, class P, class C, class L, class O>
+  Ring<T, P, C, L, O>::Ring(std::size_t size)
+    : Ring_(size * SLOT_SIZE, options_(RingOptions()))
   { }
 
-  template <class T>
-  Ring<T>::Ring(Ring<T>&& ring)
+  template <class T, class P, class C, class L, class O>
+  Ring<T, P, C, L, O>::Ring(std::size_t size, const RingOptions& options)
+    : Ring_(round_size_(size, options) * SLOT_SIZE, options_(options))
+  { }
+
+  template <class T, class P, class C, class L, class O>
+  Ring<T, P, C, L, O>::Ring(Ring&& ring)
     : Ring_(std::move(ring))
   { }
 
-  template <class T>
-  Ring<T>& Ring<T>::operator= (Ring<T>&& ring)
+  template <class T, class P, class C, class L, class O>
+  Ring<T, P, C, L, O>& Ring<T, P, C, L, O>::operator= (Ring&& ring)
   {
     destruct_();
 
-    Ring_::operator= (ring);
+    Ring_::operator= (std::move(ring));
 
     return *this;
   }
 
-  template <class T>
-  Ring<T>::~Ring()
+  template <class T, class P, class C, class L, class O>
+  Ring<T, P, C, L, O>::~Ring()
   {
     destruct_();
   }
 
-  template <class T>
-  void Ring<T>::destruct_()
+  template <class T, class P, class C, class L, class O>
+  RingOptions Ring<T, P, C, L, O>::options_(RingOptions options)
+  {
+    options.single_producer = std::is_same<P, producers::single>::value;
+    options.single_consumer = std::is_same<C, consumers::single>::value;
+    options.overwrite       = std::is_same<O, overflow::overwrite>::value;
+
+    // The element count is rounded instead, since rounding the size in bytes
+    // would let elements straddle the end of the buffer
+    options.power_of_two = false;
+
+    // Slots are aligned as long as the buffer is, since the capacity is a
+    // multiple of SLOT_SIZE. Mirroring rounds the capacity up to whole pages,
+    // which only stays a multiple if SLOT_SIZE is a power of two no larger
+    // than the smallest page
+    if (options.alignment < SLOT_ALIGN)
+      options.alignment = SLOT_ALIGN;
+    if ((SLOT_SIZE & (SLOT_SIZE - 1)) != 0 || SLOT_SIZE > 4096)
+      options.mirrored = false;
+
+    return options;
+  }
+
+  template <class T, class P, class C, class L, class O>
+  std::size_t Ring<T, P, C, L, O>::round_size_(std::size_t size, const RingOptions& options)
+  {
+    if (!options.power_of_two || size == 0)
+      return size;
+
+    std::size_t rounded = 1;
+    while (rounded < size)
+      rounded <<= 1;
+
+    return rounded;
+  }
+
+  template <class T, class P, class C, class L, class O>
+  void Ring<T, P, C, L, O>::destruct_()
   {
-    if (size() == 0)
+    if (std::is_trivially_destructible<T>::value)
       return;
 
-    auto itr = begin_data_();
     auto end = end_data_();
-    do
+    for (auto pos = begin_data_(); pos != end; pos += SLOT_SIZE)
     {
-      auto t = reinterpret_cast<T*>(itr);
+      auto t = reinterpret_cast<T*>(block_(pos));
       t->~T();
-
-      itr = normalize_(itr + sizeof(T));
-    } while (itr != end);
+    }
   }
 
-  template <class T>
-  std::size_t Ring<T>::size() const
+  template <class T, class P, class C, class L, class O>
+  std::size_t Ring<T, P, C, L, O>::size() const
   {
-    return Ring_::size() / sizeof(T);
+    return Ring_::size() / SLOT_SIZE;
   }
 
-  template <class T>
-  std::size_t Ring<T>::capacity() const
+  template <class T, class P, class C, class L, class O>
+  std::size_t Ring<T, P, C, L, O>::capacity() const
   {
-    return Ring_::capacity() / sizeof(T);
+    return Ring_::capacity() / SLOT_SIZE;
   }
 
-  template <class T>
-  void Ring<T>::read(T& data) noexcept
+  template <class T, class P, class C, class L, class O>
+  std::uint64_t Ring<T, P, C, L, O>::dropped() const
   {
-    static_assert(std::is_nothrow_move_assignable<T>::value, "T move assignment must not throw");
-    static_assert(std::is_nothrow_destructible<T>::value, "T destructor must not throw");
-
-    auto block = acquire_read_block_(sizeof(T));
+    return Ring_::dropped() / SLOT_SIZE;
+  }
 
-    // critical section
-    auto t = reinterpret_cast<T*>(block);
-    data = std::move(*t);
-    t->~T();
+  template <class T, class P, class C, class L, class O>
+  typename Ring<T, P, C, L, O>::event_handle Ring<T, P, C, L, O>::read_event() const
+  {
+    return Ring_::read_event();
+  }
 
-    release_read_block_(block, sizeof(T));
+  template <class T, class P, class C, class L, class O>
+  typename Ring<T, P, C, L, O>::event_handle Ring<T, P, C, L, O>::write_event() const
+  {
+    return Ring_::write_event();
   }
 
-  template <class T>
-  void Ring<T>::write(const T& data) noexcept
+  template <class T, class P, class C, class L, class O>
+  void Ring<T, P, C, L, O>::clear_read_event()
   {
-    static_assert(std::is_nothrow_copy_constructible<T>::value, "T copy constructor must not throw");
+    Ring_::clear_read_event();
+  }
 
-    auto block = acquire_write_block_(sizeof(T));
+  template <class T, class P, class C, class L, class O>
+  void Ring<T, P, C, L, O>::clear_write_event()
+  {
+    Ring_::clear_write_event();
+  }
 
-    // critical section
-    new(block) T(data);
+  template <class T, class P, class C, class L, class O>
+  const LatencyHistogram& Ring<T, P, C, L, O>::latency() const
+  {
+    static_assert(STAMPED, "latency() requires timing::stamped");
 
-    release_write_block_(block, sizeof(T));
+    return latency_;
   }
 
-  template <class T>
-  void Ring<T>::write(T&& data) noexcept
+  template <class T, class P, class C, class L, class O>
+  LatencyHistogram& Ring<T, P, C, L, O>::latency()
   {
-    static_assert(std::is_nothrow_move_constructible<T>::value, "T move constructor must not throw");
+    static_assert(STAMPED, "latency() requires timing::stamped");
 
-    auto block = acquire_write_block_(sizeof(T));
+    return latency_;
+  }
 
-    // critical section
-    new(block) T(std::move(data));
+  template <class T, class P, class C, class L, class O>
+  template <class... Args>
+  void Ring<T, P, C, L, O>::construct_(char* block, Args&&... args)
+  {
+    new(block) T(std::forward<Args>(args)...);
 
-    release_write_block_(block, sizeof(T));
+    if (STAMPED)
+    {
+      auto stamp = static_cast<std::int64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+      std::memcpy(block + STAMP_OFFSET, &stamp, sizeof(stamp));
+    }
   }
 
-  template <class T>
-  bool Ring<T>::try_read(T& data) noexcept
+  template <class T, class P, class C, class L, class O>
+  template <class U>
+  void Ring<T, P, C, L, O>::take_(char* block, U&& out)
   {
-    static_assert(std::is_nothrow_move_assignable<T>::value, "T move assignment must not throw");
-    static_assert(std::is_nothrow_destructible<T>::value, "T destructor must not throw");
+    auto t = reinterpret_cast<T*>(block);
+    out = std::move(*t);
+    t->~T();
 
-    auto block = try_acquire_read_block_(sizeof(T));
-    if (block == nullptr)
-      return false;
+    record_stamp_(block);
+  }
 
-    // critical section
+  template <class T, class P, class C, class L, class O>
+  template <class F>
+  void Ring<T, P, C, L, O>::consume_(char* block, F& f)
+  {
     auto t = reinterpret_cast<T*>(block);
-    data = std::move(*t);
+    f(*t);
     t->~T();
 
-    release_read_block_(block, sizeof(T));
+    record_stamp_(block);
+  }
 
-    return true;
+  template <class T, class P, class C, class L, class O>
+  void Ring<T, P, C, L, O>::record_stamp_(const char* block)
+  {
+    if (STAMPED)
+    {
+      std::int64_t stamp;
+      std::memcpy(&stamp, block + STAMP_OFFSET, sizeof(stamp));
+      auto now = static_cast<std::int64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+      record_latency_(latency_, now > stamp ? static_cast<std::uint64_t>(now - stamp) : 0);
+    }
   }
 
-  template <class T>
-  bool Ring<T>::try_write(const T& data) noexcept
+  template <class T, class P, class C, class L, class O>
+  void Ring<T, P, C, L, O>::read(T& data) noexcept
   {
-    static_assert(std::is_nothrow_copy_constructible<T>::value, "T copy constructor must not throw");
+    static_assert(std::is_nothrow_move_assignable<T>::value, "T move assignment must not throw");
+    static_assert(std::is_nothrow_destructible<T>::value, "T destructor must not throw");
 
-    auto block = try_acquire_write_block_(sizeof(T));
-    if (block == nullptr)
+    std::uint64_t pos;
+    auto block = acquire_read_block_(SLOT_SIZE, pos);
+
+    // critical section
+    take_(block, data);
+
+    release_read_block_(pos, SLOT_SIZE);
+  }
+
+  template <class T, class P, class C, class L, class O>
+  void Ring<T, P, C, L, O>::write(const T& data) noexcept(std::is_nothrow_copy_constructible<T>::value)
+  {
+    if (!std::is_nothrow_copy_constructible<T>::value)
+      return write(T(data));
+
+    std::uint64_t pos;
+    auto block = acquire_write_block_(SLOT_SIZE, pos);
+
+    // critical section
+    construct_(block, data);
+
+    release_write_block_(pos, SLOT_SIZE);
+  }
+
+  template <class T, class P, class C, class L, class O>
+  void Ring<T, P, C, L, O>::write(T&& data) noexcept
+  {
+    static_assert(std::is_nothrow_move_constructible<T>::value, "T move constructor must not throw");
+
+    std::uint64_t pos;
+    auto block = acquire_write_block_(SLOT_SIZE, pos);
+
+    // critical section
+    construct_(block, std::move(data));
+
+    release_write_block_(pos, SLOT_SIZE);
+  }
+
+  template <class T, class P, class C, class L, class O>
+  bool Ring<T, P, C, L, O>::try_read(T& data) noexcept
+  {
+    static_assert(std::is_nothrow_move_assignable<T>::value, "T move assignment must not throw");
+    static_assert(std::is_nothrow_destructible<T>::value, "T destructor must not throw");
+
+    std::uint64_t pos;
+    auto block = try_acquire_read_block_(SLOT_SIZE, pos);
+    if (block == nullptr)
+      return false;
+
+    // critical section
+    take_(block, data);
+
+    release_read_block_(pos, SLOT_SIZE);
+
+    return true;
+  }
+
+  template <class T, class P, class C, class L, class O>
+  bool Ring<T, P, C, L, O>::try_write(const T& data) noexcept(std::is_nothrow_copy_constructible<T>::value)
+  {
+    if (!std::is_nothrow_copy_constructible<T>::value)
+      return try_write(T(data));
+
+    std::uint64_t pos;
+    auto block = try_acquire_write_block_(SLOT_SIZE, pos);
+    if (block == nullptr)
       return false;
 
     // critical section
-    new(block) T(data);
+    construct_(block, data);
 
-    release_write_block_(block, sizeof(T));
+    release_write_block_(pos, SLOT_SIZE);
 
     return true;
   }
 
-  template <class T>
-  bool Ring<T>::try_write(T&& data) noexcept
+  template <class T, class P, class C, class L, class O>
+  bool Ring<T, P, C, L, O>::try_write(T&& data) noexcept
   {
     static_assert(std::is_nothrow_move_constructible<T>::value, "T move constructor must not throw");
 
-    auto block = try_acquire_write_block_(sizeof(T));
+    std::uint64_t pos;
+    auto block = try_acquire_write_block_(SLOT_SIZE, pos);
+    if (block == nullptr)
+      return false;
+
+    // critical section
+    construct_(block, std::move(data));
+
+    release_write_block_(pos, SLOT_SIZE);
+
+    return true;
+  }
+
+  template <class T, class P, class C, class L, class O>
+  template <class Rep, class Period>
+  bool Ring<T, P, C, L, O>::read_for(T& data, const std::chrono::duration<Rep, Period>& timeout) noexcept
+  {
+    return read_until(data, std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(timeout));
+  }
+
+  template <class T, class P, class C, class L, class O>
+  bool Ring<T, P, C, L, O>::read_until(T& data, time_point deadline) noexcept
+  {
+    static_assert(std::is_nothrow_move_assignable<T>::value, "T move assignment must not throw");
+    static_assert(std::is_nothrow_destructible<T>::value, "T destructor must not throw");
+
+    std::uint64_t pos;
+    auto block = acquire_read_block_(SLOT_SIZE, pos, &deadline);
+    if (block == nullptr)
+      return false;
+
+    // critical section
+    take_(block, data);
+
+    release_read_block_(pos, SLOT_SIZE);
+
+    return true;
+  }
+
+  template <class T, class P, class C, class L, class O>
+  template <class Rep, class Period>
+  bool Ring<T, P, C, L, O>::write_for(const T& data, const std::chrono::duration<Rep, Period>& timeout) noexcept(std::is_nothrow_copy_constructible<T>::value)
+  {
+    return write_until(data, std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(timeout));
+  }
+
+  template <class T, class P, class C, class L, class O>
+  template <class Rep, class Period>
+  bool Ring<T, P, C, L, O>::write_for(T&& data, const std::chrono::duration<Rep, Period>& timeout) noexcept
+  {
+    return write_until(std::move(data), std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(timeout));
+  }
+
+  template <class T, class P, class C, class L, class O>
+  bool Ring<T, P, C, L, O>::write_until(const T& data, time_point deadline) noexcept(std::is_nothrow_copy_constructible<T>::value)
+  {
+    if (!std::is_nothrow_copy_constructible<T>::value)
+      return write_until(T(data), deadline);
+
+    std::uint64_t pos;
+    auto block = acquire_write_block_(SLOT_SIZE, pos, &deadline);
+    if (block == nullptr)
+      return false;
+
+    // critical section
+    construct_(block, data);
+
+    release_write_block_(pos, SLOT_SIZE);
+
+    return true;
+  }
+
+  template <class T, class P, class C, class L, class O>
+  bool Ring<T, P, C, L, O>::write_until(T&& data, time_point deadline) noexcept
+  {
+    static_assert(std::is_nothrow_move_constructible<T>::value, "T move constructor must not throw");
+
+    std::uint64_t pos;
+    auto block = acquire_write_block_(SLOT_SIZE, pos, &deadline);
+    if (block == nullptr)
+      return false;
+
+    // critical section
+    construct_(block, std::move(data));
+
+    release_write_block_(pos, SLOT_SIZE);
+
+    return true;
+  }
+
+  template <class T, class P, class C, class L, class O>
+  template <class... Args>
+  void Ring<T, P, C, L, O>::emplace(Args&&... args) noexcept
+  {
+    static_assert(std::is_nothrow_constructible<T, Args&&...>::value, "T constructor must not throw");
+
+    std::uint64_t pos;
+    auto block = acquire_write_block_(SLOT_SIZE, pos);
+
+    // critical section
+    construct_(block, std::forward<Args>(args)...);
+
+    release_write_block_(pos, SLOT_SIZE);
+  }
+
+  template <class T, class P, class C, class L, class O>
+  template <class... Args>
+  bool Ring<T, P, C, L, O>::try_emplace(Args&&... args) noexcept
+  {
+    static_assert(std::is_nothrow_constructible<T, Args&&...>::value, "T constructor must not throw");
+
+    std::uint64_t pos;
+    auto block = try_acquire_write_block_(SLOT_SIZE, pos);
+    if (block == nullptr)
+      return false;
+
+    // critical section
+    construct_(block, std::forward<Args>(args)...);
+
+    release_write_block_(pos, SLOT_SIZE);
+
+    return true;
+  }
+
+  template <class T, class P, class C, class L, class O>
+  template <class F>
+  void Ring<T, P, C, L, O>::consume(F&& f) noexcept
+  {
+    static_assert(std::is_nothrow_destructible<T>::value, "T destructor must not throw");
+
+    std::uint64_t pos;
+    auto block = acquire_read_block_(SLOT_SIZE, pos);
+
+    // critical section
+    consume_(block, f);
+
+    release_read_block_(pos, SLOT_SIZE);
+  }
+
+  template <class T, class P, class C, class L, class O>
+  template <class F>
+  bool Ring<T, P, C, L, O>::try_consume(F&& f) noexcept
+  {
+    static_assert(std::is_nothrow_destructible<T>::value, "T destructor must not throw");
+
+    std::uint64_t pos;
+    auto block = try_acquire_read_block_(SLOT_SIZE, pos);
+    if (block == nullptr)
+      return false;
+
+    // critical section
+    consume_(block, f);
+
+    release_read_block_(pos, SLOT_SIZE);
+
+    return true;
+  }
+
+  template <class T, class P, class C, class L, class O>
+  template <class ForwardIt>
+  void Ring<T, P, C, L, O>::write_bulk(ForwardIt first, ForwardIt last) noexcept
+  {
+    static_assert(std::is_nothrow_constructible<T, decltype(*first)>::value, "T constructor must not throw");
+
+    auto length = std::distance(first, last) * SLOT_SIZE;
+    std::uint64_t pos;
+    auto block = acquire_write_block_(length, pos);
+
+    // critical section
+    construct_block_(block, first, last);
+
+    release_write_block_(pos, length);
+  }
+
+  template <class T, class P, class C, class L, class O>
+  template <class ForwardIt>
+  bool Ring<T, P, C, L, O>::try_write_bulk(ForwardIt first, ForwardIt last) noexcept
+  {
+    static_assert(std::is_nothrow_constructible<T, decltype(*first)>::value, "T constructor must not throw");
+
+    auto length = std::distance(first, last) * SLOT_SIZE;
+    std::uint64_t pos;
+    auto block = try_acquire_write_block_(length, pos);
+    if (block == nullptr)
+      return false;
+
+    // critical section
+    construct_block_(block, first, last);
+
+    release_write_block_(pos, length);
+
+    return true;
+  }
+
+  template <class T, class P, class C, class L, class O>
+  template <class OutputIt>
+  std::size_t Ring<T, P, C, L, O>::read_bulk(OutputIt out, std::size_t max) noexcept
+  {
+    static_assert(std::is_nothrow_move_assignable<T>::value, "T move assignment must not throw");
+    static_assert(std::is_nothrow_destructible<T>::value, "T destructor must not throw");
+
+    if (max == 0)
+      return 0;
+
+    auto length = max * SLOT_SIZE;
+    std::uint64_t pos;
+    auto block = acquire_some_read_block_(length, SLOT_SIZE, pos);
+
+    // critical section
+    move_block_(block, length / SLOT_SIZE, out);
+
+    release_read_block_(pos, length);
+
+    return length / SLOT_SIZE;
+  }
+
+  template <class T, class P, class C, class L, class O>
+  template <class OutputIt>
+  std::size_t Ring<T, P, C, L, O>::try_read_up_to(OutputIt out, std::size_t max) noexcept
+  {
+    static_assert(std::is_nothrow_move_assignable<T>::value, "T move assignment must not throw");
+    static_assert(std::is_nothrow_destructible<T>::value, "T destructor must not throw");
+
+    auto length = max * SLOT_SIZE;
+    std::uint64_t pos;
+    auto block = try_acquire_some_read_block_(length, SLOT_SIZE, pos);
+    if (block == nullptr)
+      return 0;
+
+    // critical section
+    move_block_(block, length / SLOT_SIZE, out);
+
+    release_read_block_(pos, length);
+
+    return length / SLOT_SIZE;
+  }
+
+  template <class T, class P, class C, class L, class O>
+  void Ring<T, P, C, L, O>::peek(T& data) noexcept(std::is_nothrow_copy_assignable<T>::value)
+  {
+    static_assert(std::is_trivially_copyable<T>::value || (std::is_same<C, consumers::single>::value && std::is_same<O, overflow::block>::value), "peeking requires a single consumer or a trivially copyable T");
+
+    std::uint64_t pos;
+    do
+      peek_(peek_block_(SLOT_SIZE, pos), data, std::is_trivially_copyable<T>());
+    while (!peek_valid_(pos));
+  }
+
+  template <class T, class P, class C, class L, class O>
+  bool Ring<T, P, C, L, O>::try_peek(T& data) noexcept(std::is_nothrow_copy_assignable<T>::value)
+  {
+    static_assert(std::is_trivially_copyable<T>::value || (std::is_same<C, consumers::single>::value && std::is_same<O, overflow::block>::value), "peeking requires a single consumer or a trivially copyable T");
+
+    std::uint64_t pos;
+    do
+    {
+      auto block = try_peek_block_(SLOT_SIZE, pos);
+      if (block == nullptr)
+        return false;
+
+      peek_(block, data, std::is_trivially_copyable<T>());
+    }
+    while (!peek_valid_(pos));
+
+    return true;
+  }
+
+  template <class T, class P, class C, class L, class O>
+  template <class F>
+  std::size_t Ring<T, P, C, L, O>::peek_each(F&& f) noexcept(noexcept(f(std::declval<const T&>())))
+  {
+    static_assert(std::is_same<C, consumers::single>::value && std::is_same<O, overflow::block>::value, "peek_each requires a single consumer");
+
+    // Only this thread releases elements, so the committed range stays
+    // valid until it reads again
+
+    auto begin = begin_data_();
+    auto end = end_data_();
+    for (auto pos = begin; pos != end; pos += SLOT_SIZE)
+    {
+      const T& t = *reinterpret_cast<const T*>(block_(pos));
+      f(t);
+    }
+
+    return static_cast<std::size_t>((end - begin) / SLOT_SIZE);
+  }
+
+  template <class T, class P, class C, class L, class O>
+  void Ring<T, P, C, L, O>::skip(std::size_t count) noexcept
+  {
+    static_assert(std::is_nothrow_destructible<T>::value, "T destructor must not throw");
+
+    if (count == 0)
+      return;
+
+    std::uint64_t pos;
+    auto block = acquire_read_block_(count * SLOT_SIZE, pos);
+
+    // critical section
+    destruct_block_(block, count);
+
+    release_read_block_(pos, count * SLOT_SIZE);
+  }
+
+  template <class T, class P, class C, class L, class O>
+  bool Ring<T, P, C, L, O>::try_skip(std::size_t count) noexcept
+  {
+    static_assert(std::is_nothrow_destructible<T>::value, "T destructor must not throw");
+
+    if (count == 0)
+      return true;
+
+    std::uint64_t pos;
+    auto block = try_acquire_read_block_(count * SLOT_SIZE, pos);
     if (block == nullptr)
       return false;
 
     // critical section
-    new(block) T(std::move(data));
+    destruct_block_(block, count);
 
-    release_write_block_(block, sizeof(T));
+    release_read_block_(pos, count * SLOT_SIZE);
 
     return true;
   }
 
+  template <class T, class P, class C, class L, class O>
+  void Ring<T, P, C, L, O>::peek_(const char* block, T& data, std::false_type)
+  {
+    data = *reinterpret_cast<const T*>(block);
+  }
+
+  template <class T, class P, class C, class L, class O>
+  void Ring<T, P, C, L, O>::peek_(const char* block, T& data, std::true_type)
+  {
+    alignas(T) char copy[sizeof(T)];
+    std::memcpy(copy, block, sizeof(T));
+    std::memcpy(&data, copy, sizeof(T));
+  }
+
+  template <class T, class P, class C, class L, class O>
+  void Ring<T, P, C, L, O>::destruct_block_(char* block, std::size_t count)
+  {
+    for (; count > 0; --count)
+    {
+      reinterpret_cast<T*>(block)->~T();
+      block = normalize_(block + SLOT_SIZE);
+    }
+  }
+
+  template <class T, class P, class C, class L, class O>
+  template <class ForwardIt>
+  void Ring<T, P, C, L, O>::construct_block_(char* block, ForwardIt first, ForwardIt last)
+  {
+    construct_block_(block, first, last, is_raw_<ForwardIt>());
+  }
+
+  template <class T, class P, class C, class L, class O>
+  template <class ForwardIt>
+  void Ring<T, P, C, L, O>::construct_block_(char* block, ForwardIt first, ForwardIt last, std::false_type)
+  {
+    // Elements never straddle the end of the buffer because the capacity is a
+    // multiple of SLOT_SIZE, so each can be constructed in place
+
+    for (; first != last; ++first)
+    {
+      construct_(block, *first);
+      block = normalize_(block + SLOT_SIZE);
+    }
+  }
+
+  template <class T, class P, class C, class L, class O>
+  template <class ForwardIt>
+  void Ring<T, P, C, L, O>::construct_block_(char* block, ForwardIt first, ForwardIt last, std::true_type)
+  {
+    copy_write_block_(block, reinterpret_cast<const char*>(first), static_cast<std::size_t>(last - first) * SLOT_SIZE);
+  }
+
+  template <class T, class P, class C, class L, class O>
+  template <class OutputIt>
+  OutputIt Ring<T, P, C, L, O>::move_block_(char* block, std::size_t count, OutputIt out)
+  {
+    return move_block_(block, count, out, is_raw_<OutputIt>());
+  }
+
+  template <class T, class P, class C, class L, class O>
+  template <class OutputIt>
+  OutputIt Ring<T, P, C, L, O>::move_block_(char* block, std::size_t count, OutputIt out, std::false_type)
+  {
+    for (; count > 0; --count)
+    {
+      take_(block, *out);
+
+      ++out;
+      block = normalize_(block + SLOT_SIZE);
+    }
+
+    return out;
+  }
+
+  template <class T, class P, class C, class L, class O>
+  template <class OutputIt>
+  OutputIt Ring<T, P, C, L, O>::move_block_(char* block, std::size_t count, OutputIt out, std::true_type)
+  {
+    copy_read_block_(block, reinterpret_cast<char*>(out), count * SLOT_SIZE);
+
+    return out + count;
+  }
+
+#if WILT_RING_COROUTINES
+  template <class T, class P, class C, class L, class O>
+  template <class Executor>
+  Ring<T, P, C, L, O>::ReadAwaiter<Executor>::ReadAwaiter(Ring* ring, Executor executor)
+    : ring_(ring)
+    , executor_(std::move(executor))
+  {
+    next = nullptr;
+    attempt = &attempt_;
+    write = false;
+    length = SLOT_SIZE;
+  }
+
+  template <class T, class P, class C, class L, class O>
+  template <class Executor>
+  bool Ring<T, P, C, L, O>::ReadAwaiter<Executor>::await_ready() noexcept
+  {
+    return ring_->try_consume([&](T& data){ data_.emplace(std::move(data)); });
+  }
+
+  template <class T, class P, class C, class L, class O>
+  template <class Executor>
+  void Ring<T, P, C, L, O>::ReadAwaiter<Executor>::await_suspend(std::coroutine_handle<> handle) noexcept
+  {
+    handle_ = handle;
+    ring_->park_async_(this);
+  }
+
+  template <class T, class P, class C, class L, class O>
+  template <class Executor>
+  T Ring<T, P, C, L, O>::ReadAwaiter<Executor>::await_resume() noexcept
+  {
+    return std::move(*data_);
+  }
+
+  template <class T, class P, class C, class L, class O>
+  template <class Executor>
+  bool Ring<T, P, C, L, O>::ReadAwaiter<Executor>::attempt_(async_waiter_* waiter)
+  {
+    // The coroutine may finish and free the awaiter as soon as it's resumed
+
+    auto self = static_cast<ReadAwaiter*>(waiter);
+    if (!self->await_ready())
+      return false;
+
+    self->executor_(self->handle_);
+    return true;
+  }
+
+  template <class T, class P, class C, class L, class O>
+  template <class Executor>
+  template <class U>
+  Ring<T, P, C, L, O>::WriteAwaiter<Executor>::WriteAwaiter(Ring* ring, U&& data, Executor executor)
+    : ring_(ring)
+    , executor_(std::move(executor))
+    , data_(std::forward<U>(data))
+  {
+    next = nullptr;
+    attempt = &attempt_;
+    write = true;
+    length = SLOT_SIZE;
+  }
+
+  template <class T, class P, class C, class L, class O>
+  template <class Executor>
+  bool Ring<T, P, C, L, O>::WriteAwaiter<Executor>::await_ready() noexcept
+  {
+    return ring_->try_write(std::move(data_));
+  }
+
+  template <class T, class P, class C, class L, class O>
+  template <class Executor>
+  void Ring<T, P, C, L, O>::WriteAwaiter<Executor>::await_suspend(std::coroutine_handle<> handle) noexcept
+  {
+    handle_ = handle;
+    ring_->park_async_(this);
+  }
+
+  template <class T, class P, class C, class L, class O>
+  template <class Executor>
+  bool Ring<T, P, C, L, O>::WriteAwaiter<Executor>::attempt_(async_waiter_* waiter)
+  {
+    auto self = static_cast<WriteAwaiter*>(waiter);
+    if (!self->await_ready())
+      return false;
+
+    self->executor_(self->handle_);
+    return true;
+  }
+
+  template <class T, class P, class C, class L, class O>
+  typename Ring<T, P, C, L, O>::template ReadAwaiter<typename Ring<T, P, C, L, O>::InlineExecutor> Ring<T, P, C, L, O>::async_read() noexcept
+  {
+    return ReadAwaiter<InlineExecutor>(this, InlineExecutor());
+  }
+
+  template <class T, class P, class C, class L, class O>
+  template <class Executor>
+  typename Ring<T, P, C, L, O>::template ReadAwaiter<Executor> Ring<T, P, C, L, O>::async_read(Executor executor) noexcept
+  {
+    return ReadAwaiter<Executor>(this, std::move(executor));
+  }
+
+  template <class T, class P, class C, class L, class O>
+  typename Ring<T, P, C, L, O>::template WriteAwaiter<typename Ring<T, P, C, L, O>::InlineExecutor> Ring<T, P, C, L, O>::async_write(const T& data)
+  {
+    return WriteAwaiter<InlineExecutor>(this, data, InlineExecutor());
+  }
+
+  template <class T, class P, class C, class L, class O>
+  typename Ring<T, P, C, L, O>::template WriteAwaiter<typename Ring<T, P, C, L, O>::InlineExecutor> Ring<T, P, C, L, O>::async_write(T&& data)
+  {
+    return WriteAwaiter<InlineExecutor>(this, std::move(data), InlineExecutor());
+  }
+
+  template <class T, class P, class C, class L, class O>
+  template <class Executor>
+  typename Ring<T, P, C, L, O>::template WriteAwaiter<Executor> Ring<T, P, C, L, O>::async_write(const T& data, Executor executor)
+  {
+    return WriteAwaiter<Executor>(this, data, std::move(executor));
+  }
+
+  template <class T, class P, class C, class L, class O>
+  template <class Executor>
+  typename Ring<T, P, C, L, O>::template WriteAwaiter<Executor> Ring<T, P, C, L, O>::async_write(T&& data, Executor executor)
+  {
+    return WriteAwaiter<Executor>(this, std::move(data), std::move(executor));
+  }
+#endif
+
 } // namespace wilt
 
 #endif // !WILT_RING_H
\ No newline at end of file
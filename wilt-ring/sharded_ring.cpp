@@ -0,0 +1,101 @@
+////////////////////////////////////////////////////////////////////////////////
+// FILE: sharded_ring.cpp
+// DATE: 2026-10-14
+// AUTH: Trevor Wilson
+// DESC: Implements a queue spread over one ring per lane with work stealing
+
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2016 Trevor Wilson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy 
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell 
+// copies of the Software, and to permit persons to whom the Software is 
+// furnished to do so, subject to the following conditions :
+// 
+//   The above copyright notice and this permission notice shall be included in
+//   all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE 
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "sharded_ring.h"
+using namespace wilt;
+
+#include <cstdint>
+// - std::uint64_t
+#include <thread>
+// - std::thread::hardware_concurrency
+// - std::this_thread::get_id
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+// - GetCurrentProcessorNumber
+#elif defined(__linux__)
+#include <sched.h>
+// - sched_getcpu
+#endif
+
+ShardedRing_::ShardedRing_(std::size_t lanes, WaitStrategy wait)
+  : lanes_(lanes != 0 ? lanes : std::thread::hardware_concurrency())
+  , waiter_(wait)
+{
+  if (lanes_ == 0)
+    lanes_ = 1;
+}
+
+ShardedRing_::ShardedRing_(ShardedRing_&& ring)
+  : lanes_(ring.lanes_)
+  , waiter_(ring.waiter_.strategy())
+{ }
+
+ShardedRing_& ShardedRing_::operator= (ShardedRing_&& ring)
+{
+  lanes_ = ring.lanes_;
+  waiter_.set_strategy(ring.waiter_.strategy());
+
+  return *this;
+}
+
+std::size_t ShardedRing_::lanes() const
+{
+  return lanes_;
+}
+
+std::size_t ShardedRing_::local_lane() const
+{
+  // Without a way to ask for the cpu, each thread keeps to a lane of its own
+
+#if defined(_WIN32)
+  return static_cast<std::size_t>(GetCurrentProcessorNumber()) % lanes_;
+#else
+#if defined(__linux__)
+  auto cpu = sched_getcpu();
+  if (cpu >= 0)
+    return static_cast<std::size_t>(cpu) % lanes_;
+#endif
+  return lane_of(std::this_thread::get_id());
+#endif
+}
+
+std::size_t ShardedRing_::lane_of_hash_(std::size_t hash) const
+{
+  // std::hash is often the identity, so the hash is mixed before it picks
+  // a lane
+
+  auto mixed = static_cast<std::uint64_t>(hash) * 0x9E3779B97F4A7C15ull;
+  return static_cast<std::size_t>((mixed >> 32) % lanes_);
+}
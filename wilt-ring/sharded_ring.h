@@ -0,0 +1,474 @@
+////////////////////////////////////////////////////////////////////////////////
+// FILE: sharded_ring.h
+// DATE: 2026-10-14
+// AUTH: Trevor Wilson
+// DESC: Defines a queue spread over one ring per lane with work stealing
+
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2016 Trevor Wilson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+//   The above copyright notice and this permission notice shall be included in
+//   all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef WILT_SHARDED_RING_H
+#define WILT_SHARDED_RING_H
+
+#include <atomic>
+// - std::atomic
+#include <chrono>
+// - std::chrono::steady_clock
+// - std::chrono::duration
+#include <cstddef>
+// - std::size_t
+#include <cstdint>
+// - std::uint64_t
+// - std::uintptr_t
+#include <functional>
+// - std::hash
+#include <new>
+// - operator new
+#include <type_traits>
+// - std::is_nothrow_copy_constructible
+#include <utility>
+// - std::forward
+// - std::move
+
+#include "ring.h"
+// - wilt::Ring
+// - wilt::RingOptions
+// - wilt::WaitStrategy
+// - wilt::detail::Waiter
+
+namespace wilt
+{
+  //////////////////////////////////////////////////////////////////////////////
+  // This structure spreads one queue over several rings, called lanes, so
+  // that threads on different cores don't all contend for the same positions.
+  // Each thread writes to the lane of the cpu it runs on, and reads from that
+  // lane first, only stealing from the other lanes when it's empty. Writes
+  // spill over to other lanes when theirs is full, and only wait for their
+  // own lane once every lane is full. Since a lane's memory is first touched
+  // by the threads writing to it, lanes usually end up on their writers'
+  // NUMA node.
+  //
+  // Elements are only ordered within a lane, and threads can move between
+  // cpus, so there is no order across the queue. Elements that must stay in
+  // order can be written to the lane of their key with lane_of() and
+  // write_lane(), which keeps them in write order as long as a lane has only
+  // one reader at a time (see read_lane()).
+  //
+  // ShardedRing_ picks lanes and makes reads wait across all of them, the
+  // lanes are any ring with the interface of Ring<T> (Ring<T> or SlotRing<T>).
+
+  class ShardedRing_
+  {
+  public:
+    ////////////////////////////////////////////////////////////////////////////
+    // TYPE DEFINITIONS
+    ////////////////////////////////////////////////////////////////////////////
+
+    typedef std::chrono::steady_clock::time_point time_point;
+
+  protected:
+    ////////////////////////////////////////////////////////////////////////////
+    // PROTECTED MEMBERS
+    ////////////////////////////////////////////////////////////////////////////
+
+    std::size_t    lanes_;  // number of lanes
+    detail::Waiter waiter_; // how blocking reads wait
+
+  protected:
+    ////////////////////////////////////////////////////////////////////////////
+    // CONSTRUCTORS AND DESTRUCTORS
+    ////////////////////////////////////////////////////////////////////////////
+
+    // Uses a lane per hardware thread if 'lanes' is 0
+    ShardedRing_(std::size_t lanes, WaitStrategy wait);
+
+    // Moves the lane count, assumes no concurrent operations
+    ShardedRing_(ShardedRing_&& ring);
+    ShardedRing_& operator= (ShardedRing_&& ring);
+
+    // No copying
+    ShardedRing_(const ShardedRing_&)             = delete;
+    ShardedRing_& operator= (const ShardedRing_&) = delete;
+
+  public:
+    ////////////////////////////////////////////////////////////////////////////
+    // QUERY FUNCTIONS
+    ////////////////////////////////////////////////////////////////////////////
+    // Functions only report on the state of the ring
+
+    // Returns the number of lanes
+    std::size_t lanes() const;
+
+    // Returns the lane of the cpu the calling thread is running on
+    std::size_t local_lane() const;
+
+    // Returns the lane elements with a key are kept in order in. Keys are
+    // hashed with std::hash
+    template <class Key>
+    std::size_t lane_of(const Key& key) const;
+
+  protected:
+    ////////////////////////////////////////////////////////////////////////////
+    // PROTECTED FUNCTIONS
+    ////////////////////////////////////////////////////////////////////////////
+
+    // Spreads a hash over the lanes
+    std::size_t lane_of_hash_(std::size_t hash) const;
+
+  }; // class ShardedRing_
+
+  //////////////////////////////////////////////////////////////////////////////
+  // Queue of T spread over lanes of type L, each with 'size' elements. Lanes
+  // should be multi-producer and multi-consumer, since any thread may write
+  // to or steal from any of them.
+
+  template <class T, class L = Ring<T>>
+  class ShardedRing : public ShardedRing_
+  {
+  public:
+    ////////////////////////////////////////////////////////////////////////////
+    // TYPE DEFINITIONS
+    ////////////////////////////////////////////////////////////////////////////
+
+    typedef ShardedRing_::time_point time_point;
+    typedef L                        lane_type;
+
+  private:
+    ////////////////////////////////////////////////////////////////////////////
+    // PRIVATE MEMBERS
+    ////////////////////////////////////////////////////////////////////////////
+    // The lanes are aligned for their type, so their positions keep to their
+    // own cache lines
+
+    char* memory_; // allocation holding the lanes
+    L*    rings_;  // the lanes
+
+  public:
+    ////////////////////////////////////////////////////////////////////////////
+    // CONSTRUCTORS AND DESTRUCTORS
+    ////////////////////////////////////////////////////////////////////////////
+
+    // Constructs 'lanes' lanes (or one per hardware thread if 0) of 'size'
+    // elements each, all with the same options
+    ShardedRing(std::size_t lanes, std::size_t size);
+    ShardedRing(std::size_t lanes, std::size_t size, const RingOptions& options);
+
+    // Moves the lanes between queues, assumes no concurrent operations
+    ShardedRing(ShardedRing&& ring);
+
+    // Moves the lanes between queues, assumes no concurrent operations on
+    // either queue. Destroys the lanes
+    ShardedRing& operator= (ShardedRing&& ring);
+
+    // No copying
+    ShardedRing(const ShardedRing&)             = delete;
+    ShardedRing& operator= (const ShardedRing&) = delete;
+
+    // Destroys the lanes, destructs stored data
+    ~ShardedRing();
+
+  public:
+    ////////////////////////////////////////////////////////////////////////////
+    // QUERY FUNCTIONS
+    ////////////////////////////////////////////////////////////////////////////
+    // Functions only report on the state of the ring
+
+    // Returns the sum of the lanes' sizes, each read at a different time
+    std::size_t size() const;
+
+    // Maximum number of elements that can be held across all lanes
+    std::size_t capacity() const;
+
+    // Returns a lane for operations not offered here. Writes through it don't
+    // wake readers parked in read() with WaitStrategy::block, so with that
+    // strategy elements for blocking readers go through write or write_lane
+    L&       lane(std::size_t lane)       { return rings_[lane]; }
+    const L& lane(std::size_t lane) const { return rings_[lane]; }
+
+  public:
+    ////////////////////////////////////////////////////////////////////////////
+    // ACCESSORS AND MODIFIERS
+    ////////////////////////////////////////////////////////////////////////////
+    // All operations assume object has not been moved. Blocking operations run
+    // until operation is completed. Non-blocking writes fail if every lane
+    // is full and non-blocking reads if every lane is empty. Blocking writes
+    // wait on the local lane, timed and blocking reads wait for any lane
+
+    void read(T& data) noexcept;
+    void write(const T& data) noexcept(std::is_nothrow_copy_constructible<T>::value);
+    void write(T&& data) noexcept;
+    bool try_read(T& data) noexcept;
+    bool try_write(const T& data) noexcept(std::is_nothrow_copy_constructible<T>::value);
+    bool try_write(T&& data) noexcept;
+
+    template <class Rep, class Period>
+    bool read_for(T& data, const std::chrono::duration<Rep, Period>& timeout) noexcept;
+    bool read_until(T& data, time_point deadline) noexcept;
+
+    // Operations on one lane only, which never spill or steal. A lane read
+    // by only one thread at a time hands out its elements in write order
+    void write_lane(std::size_t lane, const T& data) noexcept(std::is_nothrow_copy_constructible<T>::value);
+    void write_lane(std::size_t lane, T&& data) noexcept;
+    bool try_write_lane(std::size_t lane, const T& data) noexcept(std::is_nothrow_copy_constructible<T>::value);
+    bool try_write_lane(std::size_t lane, T&& data) noexcept;
+    void read_lane(std::size_t lane, T& data) noexcept;
+    bool try_read_lane(std::size_t lane, T& data) noexcept;
+
+  private:
+    ////////////////////////////////////////////////////////////////////////////
+    // PRIVATE HELPER FUNCTIONS
+    ////////////////////////////////////////////////////////////////////////////
+
+    // Tries each lane once starting from 'first'. Failed writes leave 'data'
+    // as it was
+    template <class U>
+    bool try_write_from_(std::size_t first, U&& data);
+    bool try_read_from_(std::size_t first, T& data);
+
+    void destruct_();
+
+  }; // class ShardedRing<T>
+
+  template <class Key>
+  std::size_t ShardedRing_::lane_of(const Key& key) const
+  {
+    return lane_of_hash_(std::hash<Key>()(key));
+  }
+
+  template <class T, class L>
+  ShardedRing<T, L>::ShardedRing(std::size_t lanes, std::size_t size)
+    : ShardedRing(lanes, size, RingOptions())
+  { }
+
+  template <class T, class L>
+  ShardedRing<T, L>::ShardedRing(std::size_t lanes, std::size_t size, const RingOptions& options)
+    : ShardedRing_(lanes, options.wait)
+    , memory_(new char[lanes_ * sizeof(L) + alignof(L) - 1])
+  {
+    auto address = reinterpret_cast<std::uintptr_t>(memory_);
+    rings_ = reinterpret_cast<L*>(memory_ + (alignof(L) - address % alignof(L)) % alignof(L));
+    for (std::size_t i = 0; i < lanes_; ++i)
+      new(rings_ + i) L(size, options);
+  }
+
+  template <class T, class L>
+  ShardedRing<T, L>::ShardedRing(ShardedRing&& ring)
+    : ShardedRing_(std::move(ring))
+    , memory_(ring.memory_)
+    , rings_(ring.rings_)
+  {
+    ring.memory_ = nullptr;
+    ring.rings_ = nullptr;
+    ring.lanes_ = 0;
+  }
+
+  template <class T, class L>
+  ShardedRing<T, L>& ShardedRing<T, L>::operator= (ShardedRing&& ring)
+  {
+    destruct_();
+
+    ShardedRing_::operator= (std::move(ring));
+    memory_ = ring.memory_;
+    rings_ = ring.rings_;
+
+    ring.memory_ = nullptr;
+    ring.rings_ = nullptr;
+    ring.lanes_ = 0;
+
+    return *this;
+  }
+
+  template <class T, class L>
+  ShardedRing<T, L>::~ShardedRing()
+  {
+    destruct_();
+  }
+
+  template <class T, class L>
+  void ShardedRing<T, L>::destruct_()
+  {
+    for (std::size_t i = 0; i < lanes_; ++i)
+      rings_[i].~L();
+
+    delete[] memory_;
+    memory_ = nullptr;
+    rings_ = nullptr;
+  }
+
+  template <class T, class L>
+  std::size_t ShardedRing<T, L>::size() const
+  {
+    std::size_t size = 0;
+    for (std::size_t i = 0; i < lanes_; ++i)
+      size += rings_[i].size();
+
+    return size;
+  }
+
+  template <class T, class L>
+  std::size_t ShardedRing<T, L>::capacity() const
+  {
+    std::size_t capacity = 0;
+    for (std::size_t i = 0; i < lanes_; ++i)
+      capacity += rings_[i].capacity();
+
+    return capacity;
+  }
+
+  template <class T, class L>
+  template <class U>
+  bool ShardedRing<T, L>::try_write_from_(std::size_t first, U&& data)
+  {
+    for (std::size_t i = 0; i < lanes_; ++i)
+    {
+      auto lane = first + i < lanes_ ? first + i : first + i - lanes_;
+      if (rings_[lane].try_write(std::forward<U>(data)))
+      {
+        waiter_.notify();
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  template <class T, class L>
+  bool ShardedRing<T, L>::try_read_from_(std::size_t first, T& data)
+  {
+    for (std::size_t i = 0; i < lanes_; ++i)
+    {
+      auto lane = first + i < lanes_ ? first + i : first + i - lanes_;
+      if (rings_[lane].try_read(data))
+        return true;
+    }
+
+    return false;
+  }
+
+  template <class T, class L>
+  void ShardedRing<T, L>::read(T& data) noexcept
+  {
+    auto first = local_lane();
+    waiter_.wait_until([&]{ return try_read_from_(first, data); }, nullptr);
+  }
+
+  template <class T, class L>
+  void ShardedRing<T, L>::write(const T& data) noexcept(std::is_nothrow_copy_constructible<T>::value)
+  {
+    auto first = local_lane();
+    if (try_write_from_(first, data))
+      return;
+
+    write_lane(first, data);
+  }
+
+  template <class T, class L>
+  void ShardedRing<T, L>::write(T&& data) noexcept
+  {
+    auto first = local_lane();
+    if (try_write_from_(first, std::move(data)))
+      return;
+
+    write_lane(first, std::move(data));
+  }
+
+  template <class T, class L>
+  bool ShardedRing<T, L>::try_read(T& data) noexcept
+  {
+    return try_read_from_(local_lane(), data);
+  }
+
+  template <class T, class L>
+  bool ShardedRing<T, L>::try_write(const T& data) noexcept(std::is_nothrow_copy_constructible<T>::value)
+  {
+    return try_write_from_(local_lane(), data);
+  }
+
+  template <class T, class L>
+  bool ShardedRing<T, L>::try_write(T&& data) noexcept
+  {
+    return try_write_from_(local_lane(), std::move(data));
+  }
+
+  template <class T, class L>
+  template <class Rep, class Period>
+  bool ShardedRing<T, L>::read_for(T& data, const std::chrono::duration<Rep, Period>& timeout) noexcept
+  {
+    return read_until(data, std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(timeout));
+  }
+
+  template <class T, class L>
+  bool ShardedRing<T, L>::read_until(T& data, time_point deadline) noexcept
+  {
+    auto first = local_lane();
+    return waiter_.wait_until([&]{ return try_read_from_(first, data); }, &deadline);
+  }
+
+  template <class T, class L>
+  void ShardedRing<T, L>::write_lane(std::size_t lane, const T& data) noexcept(std::is_nothrow_copy_constructible<T>::value)
+  {
+    rings_[lane].write(data);
+    waiter_.notify();
+  }
+
+  template <class T, class L>
+  void ShardedRing<T, L>::write_lane(std::size_t lane, T&& data) noexcept
+  {
+    rings_[lane].write(std::move(data));
+    waiter_.notify();
+  }
+
+  template <class T, class L>
+  bool ShardedRing<T, L>::try_write_lane(std::size_t lane, const T& data) noexcept(std::is_nothrow_copy_constructible<T>::value)
+  {
+    if (!rings_[lane].try_write(data))
+      return false;
+
+    waiter_.notify();
+    return true;
+  }
+
+  template <class T, class L>
+  bool ShardedRing<T, L>::try_write_lane(std::size_t lane, T&& data) noexcept
+  {
+    if (!rings_[lane].try_write(std::move(data)))
+      return false;
+
+    waiter_.notify();
+    return true;
+  }
+
+  template <class T, class L>
+  void ShardedRing<T, L>::read_lane(std::size_t lane, T& data) noexcept
+  {
+    rings_[lane].read(data);
+  }
+
+  template <class T, class L>
+  bool ShardedRing<T, L>::try_read_lane(std::size_t lane, T& data) noexcept
+  {
+    return rings_[lane].try_read(data);
+  }
+
+} // namespace wilt
+
+#endif // !WILT_SHARDED_RING_H
@@ -0,0 +1,319 @@
+////////////////////////////////////////////////////////////////////////////////
+// FILE: slot_ring.cpp
+// DATE: 2026-10-14
+// AUTH: Trevor Wilson
+// DESC: Implements a lock-free ring buffer of elements with per-slot sequence numbers
+
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2016 Trevor Wilson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy 
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell 
+// copies of the Software, and to permit persons to whom the Software is 
+// furnished to do so, subject to the following conditions :
+// 
+//   The above copyright notice and this permission notice shall be included in
+//   all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE 
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "slot_ring.h"
+using namespace wilt;
+
+#include <cstdint>
+// - std::int64_t
+// - std::uintptr_t
+
+namespace
+{
+  // Value of mask_ when the capacity isn't a power of two
+  const std::uint64_t NO_MASK = ~static_cast<std::uint64_t>(0);
+
+  // Deadline that has always passed, non-blocking helpers use it to check
+  // their conditions once
+  const SlotRing_::time_point IMMEDIATELY = SlotRing_::time_point::min();
+
+  // Sequence numbers of a slot waiting for the write or read of a position.
+  // They're doubled so that a written slot can't look free for the next lap
+  // even with a single slot
+  std::uint64_t writable(std::uint64_t pos) { return 2 * pos; }
+  std::uint64_t readable(std::uint64_t pos) { return 2 * pos + 1; }
+
+  // Distance of a sequence number from the one expected, wrapping safely
+  std::int64_t distance(std::uint64_t seq, std::uint64_t expected)
+  {
+    return static_cast<std::int64_t>(seq - expected);
+  }
+
+} // namespace
+
+SlotRing_::SlotRing_()
+  : memory_(nullptr)
+  , slots_(nullptr)
+  , stride_(0)
+  , offset_(0)
+  , capacity_(0)
+  , mask_(NO_MASK)
+  , waiter_(WaitStrategy::spin)
+{
+  std::atomic_init(&lap_, static_cast<std::uint64_t>(0));
+  std::atomic_init(&wpos_, static_cast<std::uint64_t>(0));
+  std::atomic_init(&rpos_, static_cast<std::uint64_t>(0));
+}
+
+SlotRing_::SlotRing_(std::size_t size, std::size_t stride, std::size_t offset, std::size_t alignment, const RingOptions& options)
+  : memory_(nullptr)
+  , slots_(nullptr)
+  , stride_(stride)
+  , offset_(offset)
+  , capacity_(size)
+  , mask_((size & (size - 1)) == 0 ? size - 1 : NO_MASK)
+  , waiter_(options.wait)
+{
+  std::atomic_init(&lap_, static_cast<std::uint64_t>(0));
+  std::atomic_init(&wpos_, static_cast<std::uint64_t>(0));
+  std::atomic_init(&rpos_, static_cast<std::uint64_t>(0));
+
+  if (size == 0)
+    return;
+
+  memory_ = new char[size * stride + alignment - 1];
+  auto address = reinterpret_cast<std::uintptr_t>(memory_);
+  slots_ = memory_ + (alignment - address % alignment) % alignment;
+
+  // Every slot starts ready for the write at its own position
+  for (std::size_t i = 0; i < size; ++i)
+    new(slots_ + i * stride) sequence_(writable(i));
+}
+
+SlotRing_::SlotRing_(SlotRing_&& ring)
+  : memory_(ring.memory_)
+  , slots_(ring.slots_)
+  , stride_(ring.stride_)
+  , offset_(ring.offset_)
+  , capacity_(ring.capacity_)
+  , mask_(ring.mask_)
+  , waiter_(ring.waiter_.strategy())
+{
+  std::atomic_init(&lap_, ring.lap_.load());
+  std::atomic_init(&wpos_, ring.wpos_.load());
+  std::atomic_init(&rpos_, ring.rpos_.load());
+
+  ring.memory_ = nullptr;
+  ring.slots_ = nullptr;
+  ring.capacity_ = 0;
+  ring.lap_ = 0;
+  ring.wpos_ = 0;
+  ring.rpos_ = 0;
+}
+
+SlotRing_& SlotRing_::operator= (SlotRing_&& ring)
+{
+  deallocate_();
+
+  memory_ = ring.memory_;
+  slots_ = ring.slots_;
+  stride_ = ring.stride_;
+  offset_ = ring.offset_;
+  capacity_ = ring.capacity_;
+  mask_ = ring.mask_;
+  waiter_.set_strategy(ring.waiter_.strategy());
+  lap_ = ring.lap_.load();
+  wpos_ = ring.wpos_.load();
+  rpos_ = ring.rpos_.load();
+
+  ring.memory_ = nullptr;
+  ring.slots_ = nullptr;
+  ring.capacity_ = 0;
+  ring.lap_ = 0;
+  ring.wpos_ = 0;
+  ring.rpos_ = 0;
+
+  return *this;
+}
+
+SlotRing_::~SlotRing_()
+{
+  deallocate_();
+}
+
+std::size_t SlotRing_::size() const
+{
+  auto rpos = rpos_.load();
+  auto wpos = wpos_.load();
+  if (wpos <= rpos)
+    return 0;
+
+  auto size = static_cast<std::size_t>(wpos - rpos);
+  return size < capacity_ ? size : capacity_;
+}
+
+std::size_t SlotRing_::capacity() const
+{
+  return capacity_;
+}
+
+char* SlotRing_::acquire_write_slot_(std::uint64_t& pos)
+{
+  if (capacity_ == 0)                                       // no slots
+  {
+    waiter_.wait_until([]{ return false; }, nullptr);       // wait forever
+    return nullptr;
+  }
+
+  pos = wpos_.fetch_add(1, std::memory_order_relaxed);      // take ticket
+  auto slot = slot_(pos);
+  auto& seq = sequence_of_(slot);
+  waiter_.wait_until([&]{                                   // check slot
+    return seq.load(std::memory_order_acquire) == writable(pos); // wait until read
+  }, nullptr);
+
+  return slot + offset_;
+}
+
+char* SlotRing_::acquire_write_slot_(std::uint64_t& pos, const time_point* deadline)
+{
+  if (capacity_ == 0)
+    return nullptr;
+
+  auto wpos = wpos_.load(std::memory_order_relaxed);        // read position
+  while (true)                                              // loop while conflict
+  {
+    auto slot = slot_(wpos);
+    auto& seq = sequence_of_(slot);
+    auto diff = distance(seq.load(std::memory_order_acquire), writable(wpos));
+    if (diff == 0)                                          // slot is free
+    {
+      if (wpos_.compare_exchange_weak(wpos, wpos + 1, std::memory_order_relaxed)) // try take
+      {
+        pos = wpos;
+        return slot + offset_;                              // taken
+      }
+    }
+    else if (diff < 0)                                      // slot not yet read
+    {
+      if (!waiter_.wait_until([&]{                          // check slot
+        return distance(seq.load(std::memory_order_acquire), writable(wpos)) >= 0 // wait until read
+            || wpos_.load(std::memory_order_relaxed) != wpos; // or taken
+      }, deadline))
+        return nullptr;                                     // return timeout
+
+      wpos = wpos_.load(std::memory_order_relaxed);         // read position
+    }
+    else                                                    // taken by another
+    {
+      wpos = wpos_.load(std::memory_order_relaxed);         // read position
+    }
+  }
+}
+
+char* SlotRing_::try_acquire_write_slot_(std::uint64_t& pos)
+{
+  return acquire_write_slot_(pos, &IMMEDIATELY);
+}
+
+void SlotRing_::release_write_slot_(std::uint64_t pos)
+{
+  sequence_of_(slot_(pos)).store(readable(pos), std::memory_order_release); // pass to reader
+  waiter_.notify();                                         // wake parked threads
+}
+
+char* SlotRing_::acquire_read_slot_(std::uint64_t& pos)
+{
+  if (capacity_ == 0)                                       // no slots
+  {
+    waiter_.wait_until([]{ return false; }, nullptr);       // wait forever
+    return nullptr;
+  }
+
+  pos = rpos_.fetch_add(1, std::memory_order_relaxed);      // take ticket
+  auto slot = slot_(pos);
+  auto& seq = sequence_of_(slot);
+  waiter_.wait_until([&]{                                   // check slot
+    return seq.load(std::memory_order_acquire) == readable(pos); // wait until written
+  }, nullptr);
+
+  return slot + offset_;
+}
+
+char* SlotRing_::acquire_read_slot_(std::uint64_t& pos, const time_point* deadline)
+{
+  if (capacity_ == 0)
+    return nullptr;
+
+  auto rpos = rpos_.load(std::memory_order_relaxed);        // read position
+  while (true)                                              // loop while conflict
+  {
+    auto slot = slot_(rpos);
+    auto& seq = sequence_of_(slot);
+    auto diff = distance(seq.load(std::memory_order_acquire), readable(rpos));
+    if (diff == 0)                                          // slot is written
+    {
+      if (rpos_.compare_exchange_weak(rpos, rpos + 1, std::memory_order_relaxed)) // try take
+      {
+        pos = rpos;
+        return slot + offset_;                              // taken
+      }
+    }
+    else if (diff < 0)                                      // slot not yet written
+    {
+      if (!waiter_.wait_until([&]{                          // check slot
+        return distance(seq.load(std::memory_order_acquire), readable(rpos)) >= 0 // wait until written
+            || rpos_.load(std::memory_order_relaxed) != rpos; // or taken
+      }, deadline))
+        return nullptr;                                     // return timeout
+
+      rpos = rpos_.load(std::memory_order_relaxed);         // read position
+    }
+    else                                                    // taken by another
+    {
+      rpos = rpos_.load(std::memory_order_relaxed);         // read position
+    }
+  }
+}
+
+char* SlotRing_::try_acquire_read_slot_(std::uint64_t& pos)
+{
+  return acquire_read_slot_(pos, &IMMEDIATELY);
+}
+
+void SlotRing_::release_read_slot_(std::uint64_t pos)
+{
+  sequence_of_(slot_(pos)).store(writable(pos + capacity_), std::memory_order_release); // pass to writer
+  waiter_.notify();                                         // wake parked threads
+}
+
+char* SlotRing_::written_slot_(std::uint64_t pos)
+{
+  auto slot = slot_(pos);
+  if (sequence_of_(slot).load() != readable(pos))
+    return nullptr;
+
+  return slot + offset_;
+}
+
+void SlotRing_::deallocate_()
+{
+  delete[] memory_;
+  memory_ = nullptr;
+  slots_ = nullptr;
+}
+
+char* SlotRing_::slot_(std::uint64_t pos)
+{
+  auto index = mask_ != NO_MASK ? pos & mask_ : detail::wrap(pos, capacity_, lap_);
+  return slots_ + static_cast<std::size_t>(index) * stride_;
+}
+
+SlotRing_::sequence_& SlotRing_::sequence_of_(char* slot)
+{
+  return *reinterpret_cast<sequence_*>(slot);
+}
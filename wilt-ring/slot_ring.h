@@ -0,0 +1,618 @@
+////////////////////////////////////////////////////////////////////////////////
+// FILE: slot_ring.h
+// DATE: 2026-10-14
+// AUTH: Trevor Wilson
+// DESC: Defines a lock-free ring buffer of elements with per-slot sequence numbers
+
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2016 Trevor Wilson
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+//   The above copyright notice and this permission notice shall be included in
+//   all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef WILT_SLOT_RING_H
+#define WILT_SLOT_RING_H
+
+#include <atomic>
+// - std::atomic
+#include <chrono>
+// - std::chrono::steady_clock
+// - std::chrono::duration
+#include <cstddef>
+// - std::size_t
+#include <cstdint>
+// - std::uint64_t
+#include <new>
+// - operator new
+#include <type_traits>
+// - std::is_nothrow_constructible
+// - std::is_nothrow_copy_constructible
+// - std::is_nothrow_move_constructible
+// - std::is_nothrow_move_assignable
+// - std::is_nothrow_destructible
+#include <utility>
+// - std::forward
+// - std::move
+
+#include "ring.h"
+// - wilt::RingOptions
+// - wilt::WaitStrategy
+// - wilt::detail::Waiter
+// - wilt::detail::wrap
+
+namespace wilt
+{
+  //////////////////////////////////////////////////////////////////////////////
+  // This structure is an alternative to Ring<T> for elements of a fixed size,
+  // with the same interface. Instead of checking the positions of the other
+  // side, each slot has a sequence number that says whose turn it is: a slot
+  // at position 'pos' can be written when its sequence is '2 * pos', and read
+  // when it's '2 * pos + 1'. Reading it sets the sequence to
+  // '2 * (pos + capacity())', for the next write to it. The doubling keeps a
+  // written slot from looking free when there is only one slot.
+  //
+  // Blocking operations take a ticket with a single fetch-add on the read or
+  // write position and then only wait on their own slot, so there are no
+  // retries and no cache line shared by both sides past the slot. They also
+  // don't wait for earlier operations to finish, only for the slot's
+  // previous lap. Non-blocking and timed operations check the slot before
+  // taking the position with a compare-exchange, since a ticket can't be
+  // given back. Without slots, blocking operations wait forever like those
+  // of a Ring<T> without a buffer.
+  //
+  //   pos    0  1  2  3  4  5  6  7
+  //   seq   16 18  5  7  8 11 12 14
+  //                |rpos       |wpos
+  //
+  // The diagram above shows a ring of 8 slots after 6 writes and 2 reads, a
+  // write of slot 4 in progress, and a write of slot 5 that completed before
+  // it. Positions are 64-bit counts that never repeat.
+  //
+  // Only the wait strategy and power_of_two options are used. SlotRing_ is
+  // the untyped engine, SlotRing<T> constructs and destroys the elements.
+
+  class SlotRing_
+  {
+  public:
+    ////////////////////////////////////////////////////////////////////////////
+    // TYPE DEFINITIONS
+    ////////////////////////////////////////////////////////////////////////////
+
+    typedef std::chrono::steady_clock::time_point time_point;
+
+  private:
+
+    typedef std::atomic<std::uint64_t> sequence_;
+
+  private:
+    ////////////////////////////////////////////////////////////////////////////
+    // PRIVATE MEMBERS
+    ////////////////////////////////////////////////////////////////////////////
+    // Each slot is its sequence number followed by the element, at 'offset_'.
+
+    char*         memory_;   // allocation holding the slots
+    char*         slots_;    // first slot, aligned for the element
+    std::size_t   stride_;   // size of a slot
+    std::size_t   offset_;   // offset of the element in a slot
+    std::size_t   capacity_; // number of slots
+    std::uint64_t mask_;     // wraps positions if the capacity is a power of two
+    std::atomic<std::uint64_t> lap_; // start of a recent lap, wraps positions
+
+    alignas(64)
+    std::atomic<std::uint64_t> wpos_; // position of the next write
+
+    alignas(64)
+    std::atomic<std::uint64_t> rpos_; // position of the next read
+
+    detail::Waiter waiter_; // how blocking operations wait
+
+  public:
+    ////////////////////////////////////////////////////////////////////////////
+    // CONSTRUCTORS AND DESTRUCTORS
+    ////////////////////////////////////////////////////////////////////////////
+
+    // Constructs a ring without slots (capacity() == 0)
+    SlotRing_();
+
+    // Constructs a ring with 'size' slots of 'stride' bytes, with elements
+    // aligned to 'alignment' at 'offset' in each slot
+    SlotRing_(std::size_t size, std::size_t stride, std::size_t offset, std::size_t alignment, const RingOptions& options);
+
+    // Moves the slots between rings, assumes no concurrent operations
+    SlotRing_(SlotRing_&& ring);
+
+    // Moves the slots between rings, assumes no concurrent operations on
+    // either ring. Deallocates the slots
+    SlotRing_& operator= (SlotRing_&& ring);
+
+    // No copying
+    SlotRing_(const SlotRing_&)             = delete;
+    SlotRing_& operator= (const SlotRing_&) = delete;
+
+    // Deallocates the slots, doesn't destruct elements
+    ~SlotRing_();
+
+  public:
+    ////////////////////////////////////////////////////////////////////////////
+    // QUERY FUNCTIONS
+    ////////////////////////////////////////////////////////////////////////////
+    // Functions only report on the state of the ring
+
+    // Returns the number of positions written but not yet taken by a read.
+    // Writes in progress are counted, and blocking operations waiting on their
+    // slot can push the count outside [0, capacity()], so it's clamped
+    std::size_t size() const;
+
+    // Maximum number of elements that can be held
+    std::size_t capacity() const;
+
+  protected:
+    ////////////////////////////////////////////////////////////////////////////
+    // PROTECTED FUNCTIONS
+    ////////////////////////////////////////////////////////////////////////////
+
+    // Takes a position and waits for its slot, returning the element storage.
+    // The timed versions take the position only once the slot is ready and
+    // return nullptr if the deadline passes first (or immediately for the
+    // try versions). Releasing passes the slot on to the other side
+    char* acquire_write_slot_(std::uint64_t& pos);
+    char* acquire_write_slot_(std::uint64_t& pos, const time_point* deadline);
+    char* try_acquire_write_slot_(std::uint64_t& pos);
+    void  release_write_slot_(std::uint64_t pos);
+
+    char* acquire_read_slot_(std::uint64_t& pos);
+    char* acquire_read_slot_(std::uint64_t& pos, const time_point* deadline);
+    char* try_acquire_read_slot_(std::uint64_t& pos);
+    void  release_read_slot_(std::uint64_t pos);
+
+    // Returns the element storage of a written and unread position, or
+    // nullptr, assumes no concurrent operations
+    char* written_slot_(std::uint64_t pos);
+
+    std::uint64_t begin_data_() const { return rpos_.load(); }
+    std::uint64_t end_data_() const   { return wpos_.load(); }
+
+  private:
+    ////////////////////////////////////////////////////////////////////////////
+    // PRIVATE HELPER FUNCTIONS
+    ////////////////////////////////////////////////////////////////////////////
+
+    void       deallocate_();
+    char*      slot_(std::uint64_t pos);
+    sequence_& sequence_of_(char* slot);
+
+  }; // class SlotRing_
+
+  //////////////////////////////////////////////////////////////////////////////
+  // Typed wrapper around SlotRing_, with the single element operations of
+  // Ring<T> and the same requirements on T. It scales better with many
+  // threads on both sides.
+
+  template <class T>
+  class SlotRing : protected SlotRing_
+  {
+  public:
+    ////////////////////////////////////////////////////////////////////////////
+    // TYPE DEFINITIONS
+    ////////////////////////////////////////////////////////////////////////////
+
+    typedef SlotRing_::time_point time_point;
+
+  private:
+
+    // The element follows the sequence number, aligned for both
+
+    static const std::size_t ALIGNMENT = alignof(T) > alignof(std::atomic<std::uint64_t>) ? alignof(T) : alignof(std::atomic<std::uint64_t>);
+    static const std::size_t OFFSET    = (sizeof(std::atomic<std::uint64_t>) + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+    static const std::size_t STRIDE    = (OFFSET + sizeof(T) + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+
+  public:
+    ////////////////////////////////////////////////////////////////////////////
+    // CONSTRUCTORS AND DESTRUCTORS
+    ////////////////////////////////////////////////////////////////////////////
+
+    // Constructs a ring without slots (capacity() == 0)
+    SlotRing();
+
+    // Constructs a ring with a number of slots
+    SlotRing(std::size_t size);
+    SlotRing(std::size_t size, const RingOptions& options);
+
+    // Moves the slots between rings, assumes no concurrent operations
+    SlotRing(SlotRing&& ring);
+
+    // Moves the slots between rings, assumes no concurrent operations on
+    // either ring. Deallocates the slots
+    SlotRing& operator= (SlotRing&& ring);
+
+    // No copying
+    SlotRing(const SlotRing&)             = delete;
+    SlotRing& operator= (const SlotRing&) = delete;
+
+    // Deallocates the slots, destructs stored data.
+    ~SlotRing();
+
+  public:
+    ////////////////////////////////////////////////////////////////////////////
+    // QUERY FUNCTIONS
+    ////////////////////////////////////////////////////////////////////////////
+    // Functions only report on the state of the ring
+
+    using SlotRing_::size;
+    using SlotRing_::capacity;
+
+  public:
+    ////////////////////////////////////////////////////////////////////////////
+    // ACCESSORS AND MODIFIERS
+    ////////////////////////////////////////////////////////////////////////////
+    // All operations assume object has not been moved. Blocking operations run
+    // until operation is completed. Non-blocking operations fail if the next
+    // slot isn't ready
+
+    // Writes of a T whose copy can throw copy it before taking a slot (even
+    // if a non-blocking write then fails), so only its move must not throw
+
+    void read(T& data) noexcept;            // blocking read
+    void write(const T& data) noexcept(std::is_nothrow_copy_constructible<T>::value);
+    void write(T&& data) noexcept;          // blocking write
+    bool try_read(T& data) noexcept;        // non-blocking read
+    bool try_write(const T& data) noexcept(std::is_nothrow_copy_constructible<T>::value);
+    bool try_write(T&& data) noexcept;      // non-blocking write
+
+    template <class Rep, class Period>
+    bool read_for(T& data, const std::chrono::duration<Rep, Period>& timeout) noexcept;
+    bool read_until(T& data, time_point deadline) noexcept;
+
+    template <class Rep, class Period>
+    bool write_for(const T& data, const std::chrono::duration<Rep, Period>& timeout) noexcept(std::is_nothrow_copy_constructible<T>::value);
+    template <class Rep, class Period>
+    bool write_for(T&& data, const std::chrono::duration<Rep, Period>& timeout) noexcept;
+    bool write_until(const T& data, time_point deadline) noexcept(std::is_nothrow_copy_constructible<T>::value);
+    bool write_until(T&& data, time_point deadline) noexcept;
+
+    // Emplacing constructs the element in its slot from the arguments, and
+    // consuming calls 'f' with a reference to the element in its slot before
+    // destructing it. 'f' must not throw
+
+    template <class... Args>
+    void emplace(Args&&... args) noexcept;
+    template <class... Args>
+    bool try_emplace(Args&&... args) noexcept;
+
+    template <class F>
+    void consume(F&& f) noexcept;
+    template <class F>
+    bool try_consume(F&& f) noexcept;
+
+  private:
+    ////////////////////////////////////////////////////////////////////////////
+    // PRIVATE HELPER FUNCTIONS
+    ////////////////////////////////////////////////////////////////////////////
+
+    void destruct_();
+
+    static std::size_t round_size_(std::size_t size, const RingOptions& options);
+
+  }; // class SlotRing<T>
+
+  template <class T>
+  SlotRing<T>::SlotRing()
+    : SlotRing_()
+  { }
+
+  template <class T>
+  SlotRing<T>::SlotRing(std::size_t size)
+    : SlotRing_(size, STRIDE, OFFSET, ALIGNMENT, RingOptions())
+  { }
+
+  template <class T>
+  SlotRing<T>::SlotRing(std::size_t size, const RingOptions& options)
+    : SlotRing_(round_size_(size, options), STRIDE, OFFSET, ALIGNMENT, options)
+  { }
+
+  template <class T>
+  SlotRing<T>::SlotRing(SlotRing&& ring)
+    : SlotRing_(std::move(ring))
+  { }
+
+  template <class T>
+  SlotRing<T>& SlotRing<T>::operator= (SlotRing&& ring)
+  {
+    destruct_();
+
+    SlotRing_::operator= (std::move(ring));
+
+    return *this;
+  }
+
+  template <class T>
+  SlotRing<T>::~SlotRing()
+  {
+    destruct_();
+  }
+
+  template <class T>
+  std::size_t SlotRing<T>::round_size_(std::size_t size, const RingOptions& options)
+  {
+    if (!options.power_of_two || size == 0)
+      return size;
+
+    std::size_t rounded = 1;
+    while (rounded < size)
+      rounded <<= 1;
+
+    return rounded;
+  }
+
+  template <class T>
+  void SlotRing<T>::destruct_()
+  {
+    auto end = end_data_();
+    for (auto pos = begin_data_(); pos < end; ++pos)
+    {
+      auto slot = written_slot_(pos);
+      if (slot != nullptr)
+        reinterpret_cast<T*>(slot)->~T();
+    }
+  }
+
+  template <class T>
+  void SlotRing<T>::read(T& data) noexcept
+  {
+    static_assert(std::is_nothrow_move_assignable<T>::value, "T move assignment must not throw");
+    static_assert(std::is_nothrow_destructible<T>::value, "T destructor must not throw");
+
+    std::uint64_t pos;
+    auto t = reinterpret_cast<T*>(acquire_read_slot_(pos));
+
+    // critical section
+    data = std::move(*t);
+    t->~T();
+
+    release_read_slot_(pos);
+  }
+
+  template <class T>
+  void SlotRing<T>::write(const T& data) noexcept(std::is_nothrow_copy_constructible<T>::value)
+  {
+    if (!std::is_nothrow_copy_constructible<T>::value)
+      return write(T(data));
+
+    std::uint64_t pos;
+    auto slot = acquire_write_slot_(pos);
+
+    // critical section
+    new(slot) T(data);
+
+    release_write_slot_(pos);
+  }
+
+  template <class T>
+  void SlotRing<T>::write(T&& data) noexcept
+  {
+    static_assert(std::is_nothrow_move_constructible<T>::value, "T move constructor must not throw");
+
+    std::uint64_t pos;
+    auto slot = acquire_write_slot_(pos);
+
+    // critical section
+    new(slot) T(std::move(data));
+
+    release_write_slot_(pos);
+  }
+
+  template <class T>
+  bool SlotRing<T>::try_read(T& data) noexcept
+  {
+    static_assert(std::is_nothrow_move_assignable<T>::value, "T move assignment must not throw");
+    static_assert(std::is_nothrow_destructible<T>::value, "T destructor must not throw");
+
+    std::uint64_t pos;
+    auto t = reinterpret_cast<T*>(try_acquire_read_slot_(pos));
+    if (t == nullptr)
+      return false;
+
+    // critical section
+    data = std::move(*t);
+    t->~T();
+
+    release_read_slot_(pos);
+    return true;
+  }
+
+  template <class T>
+  bool SlotRing<T>::try_write(const T& data) noexcept(std::is_nothrow_copy_constructible<T>::value)
+  {
+    if (!std::is_nothrow_copy_constructible<T>::value)
+      return try_write(T(data));
+
+    std::uint64_t pos;
+    auto slot = try_acquire_write_slot_(pos);
+    if (slot == nullptr)
+      return false;
+
+    // critical section
+    new(slot) T(data);
+
+    release_write_slot_(pos);
+    return true;
+  }
+
+  template <class T>
+  bool SlotRing<T>::try_write(T&& data) noexcept
+  {
+    static_assert(std::is_nothrow_move_constructible<T>::value, "T move constructor must not throw");
+
+    std::uint64_t pos;
+    auto slot = try_acquire_write_slot_(pos);
+    if (slot == nullptr)
+      return false;
+
+    // critical section
+    new(slot) T(std::move(data));
+
+    release_write_slot_(pos);
+    return true;
+  }
+
+  template <class T>
+  template <class Rep, class Period>
+  bool SlotRing<T>::read_for(T& data, const std::chrono::duration<Rep, Period>& timeout) noexcept
+  {
+    return read_until(data, std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(timeout));
+  }
+
+  template <class T>
+  bool SlotRing<T>::read_until(T& data, time_point deadline) noexcept
+  {
+    static_assert(std::is_nothrow_move_assignable<T>::value, "T move assignment must not throw");
+    static_assert(std::is_nothrow_destructible<T>::value, "T destructor must not throw");
+
+    std::uint64_t pos;
+    auto t = reinterpret_cast<T*>(acquire_read_slot_(pos, &deadline));
+    if (t == nullptr)
+      return false;
+
+    // critical section
+    data = std::move(*t);
+    t->~T();
+
+    release_read_slot_(pos);
+    return true;
+  }
+
+  template <class T>
+  template <class Rep, class Period>
+  bool SlotRing<T>::write_for(const T& data, const std::chrono::duration<Rep, Period>& timeout) noexcept(std::is_nothrow_copy_constructible<T>::value)
+  {
+    return write_until(data, std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(timeout));
+  }
+
+  template <class T>
+  template <class Rep, class Period>
+  bool SlotRing<T>::write_for(T&& data, const std::chrono::duration<Rep, Period>& timeout) noexcept
+  {
+    return write_until(std::move(data), std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(timeout));
+  }
+
+  template <class T>
+  bool SlotRing<T>::write_until(const T& data, time_point deadline) noexcept(std::is_nothrow_copy_constructible<T>::value)
+  {
+    if (!std::is_nothrow_copy_constructible<T>::value)
+      return write_until(T(data), deadline);
+
+    std::uint64_t pos;
+    auto slot = acquire_write_slot_(pos, &deadline);
+    if (slot == nullptr)
+      return false;
+
+    // critical section
+    new(slot) T(data);
+
+    release_write_slot_(pos);
+    return true;
+  }
+
+  template <class T>
+  bool SlotRing<T>::write_until(T&& data, time_point deadline) noexcept
+  {
+    static_assert(std::is_nothrow_move_constructible<T>::value, "T move constructor must not throw");
+
+    std::uint64_t pos;
+    auto slot = acquire_write_slot_(pos, &deadline);
+    if (slot == nullptr)
+      return false;
+
+    // critical section
+    new(slot) T(std::move(data));
+
+    release_write_slot_(pos);
+    return true;
+  }
+
+  template <class T>
+  template <class... Args>
+  void SlotRing<T>::emplace(Args&&... args) noexcept
+  {
+    static_assert(std::is_nothrow_constructible<T, Args&&...>::value, "T constructor must not throw");
+
+    std::uint64_t pos;
+    auto slot = acquire_write_slot_(pos);
+
+    // critical section
+    new(slot) T(std::forward<Args>(args)...);
+
+    release_write_slot_(pos);
+  }
+
+  template <class T>
+  template <class... Args>
+  bool SlotRing<T>::try_emplace(Args&&... args) noexcept
+  {
+    static_assert(std::is_nothrow_constructible<T, Args&&...>::value, "T constructor must not throw");
+
+    std::uint64_t pos;
+    auto slot = try_acquire_write_slot_(pos);
+    if (slot == nullptr)
+      return false;
+
+    // critical section
+    new(slot) T(std::forward<Args>(args)...);
+
+    release_write_slot_(pos);
+    return true;
+  }
+
+  template <class T>
+  template <class F>
+  void SlotRing<T>::consume(F&& f) noexcept
+  {
+    static_assert(std::is_nothrow_destructible<T>::value, "T destructor must not throw");
+
+    std::uint64_t pos;
+    auto t = reinterpret_cast<T*>(acquire_read_slot_(pos));
+
+    // critical section
+    f(*t);
+    t->~T();
+
+    release_read_slot_(pos);
+  }
+
+  template <class T>
+  template <class F>
+  bool SlotRing<T>::try_consume(F&& f) noexcept
+  {
+    static_assert(std::is_nothrow_destructible<T>::value, "T destructor must not throw");
+
+    std::uint64_t pos;
+    auto t = reinterpret_cast<T*>(try_acquire_read_slot_(pos));
+    if (t == nullptr)
+      return false;
+
+    // critical section
+    f(*t);
+    t->~T();
+
+    release_read_slot_(pos);
+    return true;
+  }
+
+} // namespace wilt
+
+#endif // !WILT_SLOT_RING_H